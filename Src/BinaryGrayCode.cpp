@@ -73,3 +73,59 @@ UINT CBinaryGrayCode::Next(){
 
   return i; //return bit changed
 } //Next
+
+/// Set the Gray code generator to the word with a given rank in binary
+/// reflected Gray code order, that is, the word that would be reached by
+/// that many calls to `Next()` after `Initialize()`, in time linear in the
+/// number of bits. Bit \f$i\f$ of the word is the exclusive-or of bits
+/// \f$i - 1\f$ and \f$i\f$ of the rank. The recursion stack is the identity
+/// except that for each maximal run of ones in the rank from bit \f$s\f$ to
+/// bit \f$e\f$, entry \f$s\f$ points past the end of the run to \f$e + 2\f$.
+/// Assumes that `Initialize()` has already been called and that the word
+/// has fewer than 64 bits.
+/// \param r Rank, which must be less than \f$2^n\f$.
+
+void CBinaryGrayCode::Seek(const UINT64 r){
+  m_nZeros = m_nSize; 
+
+  for(UINT i=0; i<=m_nSize+2; i++){
+    m_nGrayCodeWord[i] = 0; 
+    m_nGrayCodeStack[i] = i + 1; 
+  } //for
+
+  UINT nStart = 0; //start of current run of ones in the rank
+  UINT nPrev = 0; //previous bit of the rank
+
+  for(UINT i=1; i<=m_nSize; i++){ //for each bit
+    const UINT b = (UINT)(r >> (i - 1)) & 1; //bit i - 1 of the rank
+    const UINT nNext = (i < m_nSize)? (UINT)(r >> i) & 1: 0; //bit i of the rank
+
+    m_nGrayCodeWord[i] = b ^ nNext;
+    m_nZeros -= m_nGrayCodeWord[i]; //adjust zero count
+
+    if(b){ //in a run of ones
+      if(!nPrev)nStart = i - 1; //start of the run
+      m_nGrayCodeStack[nStart] = i + 1; //point past the end of the run so far
+    } //if
+
+    nPrev = b;
+  } //for
+} //Seek
+
+/// Get the rank of the current word in binary reflected Gray code order,
+/// that is, the number of calls to `Next()` needed to reach it after
+/// `Initialize()`. Bit \f$i - 1\f$ of the rank is the parity of bits 
+/// \f$i\f$ through \f$n\f$ of the word. This is the inverse of `Seek()`.
+/// \return Rank of the current word.
+
+const UINT64 CBinaryGrayCode::GetRank() const{
+  UINT64 r = 0; //the rank
+  UINT b = 0; //parity of bits so far
+
+  for(UINT i=m_nSize; i>=1; i--){ //from the most significant bit down
+    b ^= m_nGrayCodeWord[i];
+    r = (r << 1) | b;
+  } //for
+
+  return r;
+} //GetRank
@@ -27,7 +27,7 @@
 #define __BinaryGrayCode_h__
 
 #include "Defines.h"
-#include "Includes.h"
+#include "Platform.h"
 
 /// \brief Binary reflected Gray code generator.
 ///
@@ -71,10 +71,12 @@ class CBinaryGrayCode{
     UINT* m_nGrayCodeStack = nullptr; ///< Stack to remove recursion.
 
   public:
-    ~CBinaryGrayCode(); ///< Destructor.
+    virtual ~CBinaryGrayCode(); ///< Destructor.
 
     virtual void Initialize(const UINT); ///< Get first code word.
     virtual UINT Next(); ///< Get next code word.
+    virtual void Seek(const UINT64); ///< Jump to code word of given rank.
+    virtual const UINT64 GetRank() const; ///< Get rank of current code word.
 }; //CBinaryGrayCode
 
 #endif //__BinaryGrayCode_h__
\ No newline at end of file
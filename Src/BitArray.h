@@ -0,0 +1,173 @@
+/// \file BitArray.h
+/// \brief Interface and code for the two-dimensional bit array CBitArray.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __BitArray_h__
+#define __BitArray_h__
+
+#include <cassert>
+#include <cstring>
+
+#include "FlatArray.h"
+
+/// \brief Flat two-dimensional array of bits.
+///
+/// `CBitArray` is a two-dimensional array of bits packed 64 to a word, with
+/// each row starting on a new word. The words are stored in a `CFlatArray`,
+/// so there is one allocation aligned to a cache line. Bits past the end of
+/// a row are always zero, which lets whole rows be filled, cleared, and
+/// merged a word at a time. Bit \f$(i, j)\f$ is bit \f$j \bmod 64\f$ of
+/// word \f$\lfloor j/64 \rfloor\f$ of row \f$i\f$, which can be accessed
+/// either through the member functions or directly from the row pointer
+/// returned by `a[i]`.
+
+class CBitArray{
+  private:
+    CFlatArray<UINT64> m_nWord; ///< Words, one row per row of bits.
+    UINT m_nCols = 0; ///< Number of columns, that is, bits per row.
+
+    /// Get a mask for the valid bits in the last word of a row.
+    /// \return Mask with a one in each bit that is in a column.
+
+    const UINT64 GetLastMask() const{
+      const UINT r = m_nCols & 63; //number of bits used in the last word
+      return r? (1ULL << r) - 1: ~0ULL;
+    } //GetLastMask
+
+  public:
+    /// Get the number of words needed for a row.
+    /// \param nCols Number of columns.
+    /// \return Number of 64-bit words.
+
+    static const UINT GetWords(const UINT nCols){
+      return (nCols + 63)/64;
+    } //GetWords
+
+    /// Set the number of rows and columns and set every bit to the same
+    /// value. The old bits are not kept. If memory runs out, the array is
+    /// left empty.
+    /// \param nRows Number of rows.
+    /// \param nCols Number of columns.
+    /// \param b Initial value of every bit.
+    /// \return true if the memory was allocated.
+
+    bool Create(const UINT nRows, const UINT nCols, const bool b){
+      m_nCols = nCols;
+
+      if(!m_nWord.Create(nRows, GetWords(nCols), 0)){ //bail and fail
+        m_nCols = 0;
+        return false;
+      } //if
+
+      if(b)Fill(0, nRows, true);
+      return true;
+    } //Create
+
+    /// Set every bit in a range of rows to the same value, a word at a time.
+    /// \param first First row.
+    /// \param last One past the last row.
+    /// \param b Value of every bit.
+
+    void Fill(const UINT first, const UINT last, const bool b){
+      const UINT nWords = m_nWord.GetCols(); //words per row
+      if(nWords == 0)return; //nothing to do
+
+      for(UINT i=first; i<last; i++){ //for each row in range
+        UINT64* p = m_nWord[i]; //first word in row
+        memset(p, b? 0xFF: 0, nWords*sizeof(UINT64));
+        p[nWords - 1] &= GetLastMask(); //keep the padding zero
+      } //for
+    } //Fill
+
+    /// Get a row.
+    /// \param i Row index.
+    /// \return Pointer to the first word in row \f$i\f$.
+
+    UINT64* operator[](const UINT i){
+      return m_nWord[i];
+    } //operator[]
+
+    /// Get a row.
+    /// \param i Row index.
+    /// \return Pointer to the first word in row \f$i\f$.
+
+    const UINT64* operator[](const UINT i) const{
+      return m_nWord[i];
+    } //operator[]
+
+    /// Get a bit.
+    /// \param i Row index.
+    /// \param j Column index.
+    /// \return Bit in row \f$i\f$ and column \f$j\f$.
+
+    const bool operator()(const UINT i, const UINT j) const{
+      assert(j < m_nCols);
+      return (m_nWord[i][j >> 6] >> (j & 63)) & 1;
+    } //operator()
+
+    /// Set a bit to one.
+    /// \param i Row index.
+    /// \param j Column index.
+
+    void Set(const UINT i, const UINT j){
+      assert(j < m_nCols);
+      m_nWord[i][j >> 6] |= 1ULL << (j & 63);
+    } //Set
+
+    /// Set a bit to a value.
+    /// \param i Row index.
+    /// \param j Column index.
+    /// \param b New value of the bit.
+
+    void Set(const UINT i, const UINT j, const bool b){
+      assert(j < m_nCols);
+      const UINT64 mask = 1ULL << (j & 63); //mask for bit in its word
+      UINT64& w = m_nWord[i][j >> 6]; //word containing the bit
+      w = b? (w | mask): (w & ~mask);
+    } //Set
+
+    /// Get the number of rows.
+    /// \return Number of rows.
+
+    const UINT GetRows() const{
+      return m_nWord.GetRows();
+    } //GetRows
+
+    /// Get the number of columns.
+    /// \return Number of columns.
+
+    const UINT GetCols() const{
+      return m_nCols;
+    } //GetCols
+
+    /// Whether there are no bits.
+    /// \return true if there are no bits.
+
+    const bool IsEmpty() const{
+      return m_nWord.IsEmpty();
+    } //IsEmpty
+}; //CBitArray
+
+#endif //__BitArray_h__
@@ -0,0 +1,229 @@
+/// \file BitSlicedVerifier.cpp
+/// \brief Code for the bit-sliced zero-one verifier CBitSlicedVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "BitSlicedVerifier.h"
+
+/// Flatten the comparators into arrays in level order and divide the channels
+/// above the sixth into units to be enumerated, either single channels or
+/// (for first normal form) pairs of channels.
+/// \param nInputs Number of inputs.
+/// \param vecLevel Array of `std::vector`s of min-max `CComparator`s.
+/// \param nDepth Number of entries in `vecLevel`.
+/// \param bFirstNormalForm True if the comparator network is in first
+/// normal form.
+/// \param k Lane kernel. The portable kernel is used instead if this
+/// processor doesn't support it.
+
+CBitSlicedVerifier::CBitSlicedVerifier(const UINT nInputs, 
+  std::vector<CComparator>* vecLevel, const UINT nDepth,
+  const bool bFirstNormalForm, const eKernel k):
+  m_nInputs(nInputs), m_nDepth(nDepth), m_bFirstNormalForm(bFirstNormalForm)
+{
+  m_eKernel = KernelSupported(k)? k: eKernel::Scalar;
+  m_pKernel = GetKernel(m_eKernel);
+  m_nWords = KernelWords(m_eKernel);
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    m_nSize += (UINT)vecLevel[i].size();
+
+  m_nMin = new UINT[m_nSize];
+  m_nMax = new UINT[m_nSize];
+  m_nLevel = new UINT[m_nSize];
+  m_nSwapped = new UINT64[m_nSize*m_nWords];
+
+  UINT c = 0; //comparator index
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(auto& p: vecLevel[i]){ //for each comparator at that level
+      m_nMin[c] = p.m_nMin;
+      m_nMax[c] = p.m_nMax;
+      m_nLevel[c] = i;
+      ++c;
+    } //for
+
+  m_nInput = new UINT64[m_nInputs*m_nWords];
+  m_nValue = new UINT64[m_nInputs*m_nWords];
+
+  m_nUnitChannel = new UINT[m_nInputs];
+  m_nUnitRadix = new UINT[m_nInputs];
+  m_nUnitDigit = new UINT[m_nInputs];
+
+  for(UINT j=6; j<m_nInputs; j++){ //for each channel above the sixth
+    m_nUnitChannel[m_nUnits] = j;
+    
+    if(m_bFirstNormalForm && j + 1 < m_nInputs){ //pair of channels
+      m_nUnitRadix[m_nUnits] = 3;
+      ++j; //skip the other channel in the pair
+    } //if
+
+    else m_nUnitRadix[m_nUnits] = 2; //single channel
+
+    ++m_nUnits;
+  } //for
+} //constructor
+
+/// Delete the comparator arrays, the value arrays, and the unit arrays.
+
+CBitSlicedVerifier::~CBitSlicedVerifier(){
+  delete [] m_nMin;
+  delete [] m_nMax;
+  delete [] m_nLevel;
+  delete [] m_nSwapped;
+
+  delete [] m_nInput;
+  delete [] m_nValue;
+
+  delete [] m_nUnitChannel;
+  delete [] m_nUnitRadix;
+  delete [] m_nUnitDigit;
+} //destructor
+
+/// Set one input word for the channels in a unit from its current value.
+/// A single channel gets all zeros or all ones. A pair of channels gets 
+/// 00, 01, or 11 (min channel first) in every bit.
+/// \param u Unit index.
+/// \param w Index of word within each channel.
+
+void CBitSlicedVerifier::SetUnit(const UINT u, const UINT w){
+  const UINT j = m_nUnitChannel[u]; //first channel in unit
+  const UINT d = m_nUnitDigit[u]; //current value of unit
+
+  if(m_nUnitRadix[u] == 2) //single channel
+    m_nInput[j*m_nWords + w] = d? ~0ULL: 0ULL;
+
+  else{ //pair of channels
+    m_nInput[j*m_nWords + w] = (d == 2)? ~0ULL: 0ULL;
+    m_nInput[(j + 1)*m_nWords + w] = (d > 0)? ~0ULL: 0ULL;
+  } //else
+} //SetUnit
+
+/// Initialize the input to the first block, in which the six least 
+/// significant channels take all combinations of zeros and ones in every
+/// word and the remaining channels are zero.
+
+void CBitSlicedVerifier::InitInput(){
+  for(UINT j=0; j<m_nInputs && j<6; j++) //six least significant channels
+    for(UINT w=0; w<m_nWords; w++) //for each word
+      m_nInput[j*m_nWords + w] = g_nLane[j];
+
+  for(UINT u=0; u<m_nUnits; u++) //for each unit
+    m_nUnitDigit[u] = 0;
+} //InitInput
+
+/// Advance the input to the next block by incrementing the mixed-radix
+/// number whose digits are the values of the units. If there are no more
+/// blocks then it wraps around to the first one.
+/// \return false if there are no more blocks.
+
+bool CBitSlicedVerifier::NextInput(){
+  for(UINT u=0; u<m_nUnits; u++){ //for each unit, least significant first
+    if(++m_nUnitDigit[u] < m_nUnitRadix[u])return true; //no carry
+    m_nUnitDigit[u] = 0; //carry
+  } //for
+
+  return false;
+} //NextInput
+
+/// Check whether the comparator network sorts all zero-one inputs, one block
+/// of 64 per word at a time. Each word of the channels gets the next block
+/// in turn, and the kernel then processes all of the words at once. If we
+/// run out of blocks part way through, then the remaining words get the first
+/// block again, which does no harm. Bails out at the first group of blocks
+/// that doesn't sort.
+/// \return true if it sorts.
+
+bool CBitSlicedVerifier::Verify(){
+  for(UINT c=0; c<m_nSize; c++){ //first level of first normal form is used
+    const UINT64 n = (m_bFirstNormalForm && m_nLevel[c] == 0)? ~0ULL: 0ULL; 
+
+    for(UINT w=0; w<m_nWords; w++) //for each word
+      m_nSwapped[c*m_nWords + w] = n;
+  } //for
+
+  InitInput(); //first block
+  bool bSorts = true; //true if it sorts so far
+  bool bMore = true; //true if there are more blocks
+
+  while(bSorts && bMore){ //bail if it doesn't sort, or we've run out
+    for(UINT w=0; w<m_nWords; w++){ //give each word the next block
+      for(UINT u=0; u<m_nUnits; u++) //for each unit
+        SetUnit(u, w);
+
+      if(bMore)bMore = NextInput();
+    } //for
+
+    bSorts = m_pKernel(m_nMin, m_nMax, m_nSize, m_nInputs, m_nInput, m_nValue,
+      m_nSwapped);
+  } //while
+
+  return bSorts;
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs during `Verify()` as used. Other entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CBitSlicedVerifier::GetUsage(CBitArray& bUsed) const{
+  for(UINT c=0; c<m_nSize; c++){ //for each comparator
+    UINT64 n = 0; //inputs on which it swapped
+
+    for(UINT w=0; w<m_nWords; w++) //for each word
+      n |= m_nSwapped[c*m_nWords + w];
+
+    if(n){ //mark both channels used
+      bUsed.Set(m_nLevel[c], m_nMin[c]);
+      bUsed.Set(m_nLevel[c], m_nMax[c]);
+    } //if
+  } //for
+} //GetUsage
+
+/// Get the first input in the last group of blocks processed by `Verify()`
+/// that was not sorted, in the order in which the inputs were enumerated.
+/// This is only meaningful if `Verify()` returned false.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted input was found.
+
+bool CBitSlicedVerifier::GetCounterexample(std::vector<UINT>& vInput) const{
+  for(UINT w=0; w<m_nWords; w++){ //for each word
+    UINT64 nUnsorted = 0; //bits for unsorted outputs
+
+    for(UINT j=0; j+1<m_nInputs; j++) //for each adjacent pair of channels
+      nUnsorted |= m_nValue[j*m_nWords + w] & ~m_nValue[(j + 1)*m_nWords + w];
+
+    if(nUnsorted){ //found one
+      UINT b = 0; //index of least significant one bit
+      while(!((nUnsorted >> b) & 1))++b;
+
+      vInput.resize(m_nInputs);
+
+      for(UINT j=0; j<m_nInputs; j++) //for each channel
+        vInput[j] = (UINT)(m_nInput[j*m_nWords + w] >> b) & 1;
+
+      return true;
+    } //if
+  } //for
+
+  return false;
+} //GetCounterexample
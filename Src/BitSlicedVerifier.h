@@ -0,0 +1,93 @@
+/// \file BitSlicedVerifier.h
+/// \brief Interface for the bit-sliced zero-one verifier CBitSlicedVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __BitSlicedVerifier_h__
+#define __BitSlicedVerifier_h__
+
+#include "Platform.h"
+#include "ComparatorNetwork.h"
+#include "LaneKernels.h"
+
+/// \brief Bit-sliced zero-one verifier.
+///
+/// `CBitSlicedVerifier` tests whether a comparator network is a sorting network
+/// using the _Zero-One Principle_, like `CSortingNetwork::sorts()`, but it
+/// evaluates 64 zero-one inputs at once instead of one at a time. The value on
+/// each channel is stored as a 64-bit word in which bit \f$b\f$ is the value
+/// on that channel for the \f$b\f$th input of the current block of 64 inputs.
+/// A comparator between channels \f$j < k\f$ then becomes a pair of word
+/// operations, an AND for the min on channel \f$j\f$ and an OR for the max
+/// on channel \f$k\f$, with no branches at all.
+///
+/// The 64 bits of each word on the six least significant channels run through
+/// all 64 combinations of zeros and ones. The remaining channels are held
+/// constant across each block and enumerated one block at a time. If the
+/// comparator network is in first normal form, then each pair of channels
+/// \f$2i, 2i + 1\f$ above the sixth is only given the values 00, 01, and 11,
+/// for the same reason that `CTernaryGrayCode` skips the bit pair 10.
+///
+/// The actual work is done by a lane kernel (see `LaneKernels.h`), which may
+/// use SIMD instructions to process 4 or 8 words per channel at once, that is,
+/// 256 or 512 inputs. Each word gets its own block of inputs.
+
+class CBitSlicedVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    UINT m_nSize = 0; ///< Size (number of comparators).
+    bool m_bFirstNormalForm = false; ///< Whether in first normal form.
+
+    eKernel m_eKernel = eKernel::Scalar; ///< Lane kernel.
+    LaneKernel m_pKernel = nullptr; ///< Lane kernel function.
+    UINT m_nWords = 1; ///< Number of 64-bit words per channel.
+
+    UINT* m_nMin = nullptr; ///< Min channel of each comparator in level order.
+    UINT* m_nMax = nullptr; ///< Max channel of each comparator in level order.
+    UINT* m_nLevel = nullptr; ///< Level of each comparator.
+
+    UINT64* m_nInput = nullptr; ///< Input on each channel for current block.
+    UINT64* m_nValue = nullptr; ///< Value on each channel for current block.
+    UINT64* m_nSwapped = nullptr; ///< Inputs on which each comparator swaps.
+
+    UINT m_nUnits = 0; ///< Number of enumerated channels or channel pairs.
+    UINT* m_nUnitChannel = nullptr; ///< First channel of each unit.
+    UINT* m_nUnitRadix = nullptr; ///< Number of values of each unit, 2 or 3.
+    UINT* m_nUnitDigit = nullptr; ///< Current value of each unit.
+
+    void SetUnit(const UINT, const UINT); ///< Set the input for a unit.
+    void InitInput(); ///< Initialize the input to the first block.
+    bool NextInput(); ///< Advance the input to the next block.
+
+  public:
+    CBitSlicedVerifier(const UINT, std::vector<CComparator>*, const UINT,
+      const bool, const eKernel=eKernel::Scalar); ///< Constructor.
+    ~CBitSlicedVerifier(); ///< Destructor.
+
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    bool GetCounterexample(std::vector<UINT>&) const; ///< Get unsorted input.
+}; //CBitSlicedVerifier
+
+#endif //__BitSlicedVerifier_h__
@@ -28,27 +28,6 @@
 
 #include "SortingNetwork.h"
 
-/// \brief A min-max or max-min comparator used in bitonic sort.
-///
-/// This can be either a min-max comparator (when the index of the min channel
-/// is less than the index of the max channel) or a max-min comparator (when 
-/// the index of the min channel is greater than the index of the max channel).
-/// Max-min channels are necessary during the construction of the bitonic
-/// sorting network.
-
-class CComparator{
-  public:
-    UINT m_nMin = 0; ///< Channel index of minimum.
-    UINT m_nMax = 0; ///< Channel index of maximum.
-
-    /// \brief Constructor.
-    ///
-    /// \param nMin Channel index of minimum.
-    /// \param nMax Channel index of maximum.
-
-    CComparator(UINT nMin, UINT nMax): m_nMin(nMin), m_nMax(nMax){}; 
-}; //CComparator
-
 /// \brief Batcher's bitonic sorting network.
 ///
 /// Batcher's bitonic sorting network has number of inputs a power of 2.
@@ -61,10 +40,7 @@ class CComparator{
 
 class CBitonicSort: public CSortingNetwork{
   private:
-    void CreateComparators(std::vector<CComparator>*); ///< Create comparators.
-    void MakeAllMinMax(std::vector<CComparator>*); ///< Make all comparators min-max.
-    void Twist(std::vector<CComparator>*, UINT, UINT, UINT); ///< Twist channels.
-    void CreateMatchArray(std::vector<CComparator>*); ///< Create match array.
+    void CreateComparators(); ///< Create comparators.
 
   public:
     CBitonicSort(const UINT); ///< Constructor.
@@ -308,6 +308,20 @@ bool CMain::Verify(){
     s = "This is a " + strInputs + "-input comparator network " + strDetails +
       " that is not a sorting network.";
     nIcon = MB_ICONERROR;
+
+    CCounterexample c; //input that isn't sorted
+
+    if(m_pSortingNetwork->GetCounterexample(c)){
+      std::string strInput, strOutput; //input and output as bit strings
+
+      for(UINT j=0; j<c.m_vInput.size(); j++){
+        strInput += std::to_string(c.m_vInput[j]);
+        strOutput += std::to_string(c.m_vOutput[j]);
+      } //for
+
+      s += " For example, it takes input " + strInput + " to " + strOutput;
+      s += ", which can't be sorted after the first " + std::to_string(c.m_nLevel) + " levels.";
+    } //if
   } //else
   
   //first normal form
@@ -333,6 +347,51 @@ bool CMain::Verify(){
   return result;
 } //Verify
 
+/// Pop up a message box that tells the user whether every lane kernel
+/// supported by this processor gives the same result as the Gray code
+/// version of the verification engine on each of the sample comparator
+/// network files, which must be in the current directory.
+
+void CMain::SelfTest(){
+  const char* strFile[] = { //sample comparator network files
+    "w4d3s5.txt", "w5d5s8.txt", "w6d5s12.txt", "w7d6s16.txt", "w8d6s19.txt",
+    "w9d7s27.txt", "w10d7s31.txt", "w10d7s32.txt", "knuth16.txt",
+    "does-not-sort.txt"
+  }; //strFile
+
+  std::string s = "Lane kernels:"; //for message box text
+
+  for(eKernel k: {eKernel::Scalar, eKernel::Avx2, eKernel::Avx512})
+    if(KernelSupported(k))
+      s += " " + KernelName(k);
+
+  s += ".\n";
+
+  bool bPassed = true; //true if all tests passed so far
+
+  for(const char* p: strFile){ //for each sample file
+    const std::string strName(p); //file name
+    std::wstring wstrName(strName.begin(), strName.end()); //wide file name
+    CSortingNetwork net; //comparator network
+
+    s += "\n" + strName + ": ";
+
+    if(net.Read((LPWSTR)wstrName.c_str())){ //read succeeded
+      const bool ok = net.SelfTest();
+      bPassed = bPassed && ok;
+      s += ok? "passed": "FAILED";
+    } //if
+
+    else{ //read failed
+      bPassed = false;
+      s += "not found";
+    } //else
+  } //for
+
+  const UINT nIcon = bPassed? MB_ICONINFORMATION: MB_ICONERROR; //icon flag
+  MessageBox(nullptr, s.c_str(), "Self Test", nIcon | MB_OK);
+} //SelfTest
+
 /// Set the draw style and put a checkmark next to the corresponding menu item.
 /// \param d Draw style enumerated type.
 
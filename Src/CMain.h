@@ -59,6 +59,7 @@ class CMain{
     void Read(); ///< Read comparator network from file.
     void Draw(); ///< Draw comparator network to bitmap.
     bool Verify(); ///< Verify that comparator network sorts.
+    void SelfTest(); ///< Test the verification engines.
 
     void OnPaint(); ///< Paint the client area of the window.
     Gdiplus::Bitmap* GetBitmap(); ///< Get pointer to bitmap.
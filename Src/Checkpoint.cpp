@@ -0,0 +1,154 @@
+/// \file Checkpoint.cpp
+/// \brief Code for the verification checkpoint CCheckpoint.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstring>
+
+#include "Checkpoint.h"
+#include "Helpers.h"
+#include "MappedFile.h"
+
+static const UINT g_nMagic = 0x50434E53; ///< "SNCP" for sorting network checkpoint.
+static const UINT g_nVersion = 1; ///< File format version.
+
+/// Append the bytes of a value to a byte buffer.
+/// \param v [IN, OUT] Byte buffer.
+/// \param x Value.
+
+template<class t> static void Put(std::vector<unsigned char>& v, const t& x){
+  const unsigned char* p = (const unsigned char*)&x; //bytes of x
+  v.insert(v.end(), p, p + sizeof(t));
+} //Put
+
+/// Get a value from a byte buffer and advance the read position past it.
+/// \param v Byte buffer.
+/// \param n [IN, OUT] Read position.
+/// \param x [OUT] Value.
+/// \return true if there were enough bytes left.
+
+template<class t> static bool Get(const std::vector<unsigned char>& v, size_t& n, t& x){
+  if(n + sizeof(t) > v.size())return false; //bail and fail
+
+  memcpy(&x, &v[n], sizeof(t));
+  n += sizeof(t);
+
+  return true;
+} //Get
+
+/// Save the checkpoint to a file. The format is a header (magic number,
+/// version, number of inputs, depth, comparator network hash, rank, and
+/// two flags), followed by the usage flags packed eight to a byte, followed
+/// by an FNV-1a hash of everything before it. The whole thing is assembled
+/// in memory and written with a single call to a temporary file next to the
+/// checkpoint, which is flushed and closed and then renamed over the
+/// checkpoint, so that a crash part way through a save leaves the previous
+/// checkpoint intact.
+/// \param wstrName File name.
+/// \return true if the file was written.
+
+bool CCheckpoint::Save(const std::wstring& wstrName) const{
+  std::vector<unsigned char> v; //file contents
+
+  Put(v, g_nMagic);
+  Put(v, g_nVersion);
+  Put(v, m_nInputs);
+  Put(v, m_nDepth);
+  Put(v, m_nHash);
+  Put(v, m_nRank);
+  Put(v, (unsigned char)m_bFinished);
+  Put(v, (unsigned char)m_bSorts);
+
+  const size_t nStart = v.size(); //start of usage flags
+  v.resize(nStart + (m_vUsed.size() + 7)/8, 0);
+
+  for(size_t i=0; i<m_vUsed.size(); i++)
+    if(m_vUsed[i])
+      v[nStart + i/8] |= 1 << (i%8);
+
+  Put(v, Fnv1a(v.data(), v.size())); //hash of contents
+
+  const std::wstring wstrTemp = wstrName + L".tmp"; //temporary file name
+
+  FILE* pOutput = nullptr; //output file
+  _wfopen_s(&pOutput, wstrTemp.c_str(), L"wb");
+  if(pOutput == nullptr)return false; //bail and fail
+
+  bool ok = fwrite(v.data(), 1, v.size(), pOutput) == v.size();
+  ok = fflush(pOutput) == 0 && ok;
+  ok = fclose(pOutput) == 0 && ok;
+  if(!ok)return false; //bail and fail, leaving the checkpoint alone
+
+#ifdef _WIN32
+  return MoveFileExW(wstrTemp.c_str(), wstrName.c_str(),
+    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  return _wrename(wstrTemp.c_str(), wstrName.c_str()) == 0;
+#endif
+} //Save
+
+/// Load the checkpoint from a file. The file is rejected if it is truncated
+/// or has been corrupted, or if it is from a different version.
+/// \param wstrName File name.
+/// \return true if the file was read and is consistent.
+
+bool CCheckpoint::Load(const std::wstring& wstrName){
+  CMappedFile file; //input file
+  if(!file.Open(wstrName.c_str()))return false; //bail and fail
+
+  const std::vector<unsigned char> v(file.GetData(),
+    file.GetData() + file.GetSize()); //file contents
+
+  if(v.size() < sizeof(UINT64))return false; //bail and fail
+
+  const size_t nBody = v.size() - sizeof(UINT64); //size without the hash
+  size_t n = nBody; //read position
+  UINT64 nCheck = 0; //hash of contents
+
+  if(!Get(v, n, nCheck) || nCheck != Fnv1a(v.data(), nBody))
+    return false; //bail and fail
+
+  n = 0;
+  UINT nMagic = 0, nVersion = 0; //magic number and version
+  unsigned char bFinished = 0, bSorts = 0; //flags
+
+  bool ok = Get(v, n, nMagic) && nMagic == g_nMagic &&
+    Get(v, n, nVersion) && nVersion == g_nVersion &&
+    Get(v, n, m_nInputs) && Get(v, n, m_nDepth) &&
+    Get(v, n, m_nHash) && Get(v, n, m_nRank) && 
+    Get(v, n, bFinished) && Get(v, n, bSorts);
+
+  const size_t nUsed = (size_t)m_nInputs*m_nDepth; //number of usage flags
+  ok = ok && n + (nUsed + 7)/8 == nBody;
+
+  if(ok){
+    m_bFinished = bFinished != 0;
+    m_bSorts = bSorts != 0;
+    m_vUsed.assign(nUsed, false);
+
+    for(size_t i=0; i<nUsed; i++)
+      m_vUsed[i] = (v[n + i/8] >> (i%8)) & 1;
+  } //if
+
+  return ok;
+} //Load
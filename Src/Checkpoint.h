@@ -0,0 +1,56 @@
+/// \file Checkpoint.h
+/// \brief Interface for the verification checkpoint CCheckpoint.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __Checkpoint_h__
+#define __Checkpoint_h__
+
+#include "Platform.h"
+
+/// \brief Verification checkpoint.
+///
+/// `CCheckpoint` is a snapshot of the state of `CSortingNetwork::sorts()` using
+/// the Gray code verification engine, which is small enough to be saved to a
+/// file every few minutes during a long verification run so that the run
+/// can be resumed after a crash. It consists of the rank of the last Gray code
+/// word that was verified, a hash of the comparator network so that we don't
+/// resume verification of a different one by mistake, and the usage flags
+/// accumulated so far. The file ends with a hash of its contents so that a
+/// file that was only partly written is rejected.
+
+class CCheckpoint{
+  public:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    UINT64 m_nHash = 0; ///< Hash of the comparator network.
+    UINT64 m_nRank = 0; ///< Rank of the last Gray code word verified.
+    bool m_bFinished = false; ///< Whether verification has finished.
+    bool m_bSorts = false; ///< Whether it sorts, if finished.
+    std::vector<bool> m_vUsed; ///< Usage flags indexed by level then channel.
+
+    bool Save(const std::wstring&) const; ///< Save to file.
+    bool Load(const std::wstring&); ///< Load from file.
+}; //CCheckpoint
+
+#endif //__Checkpoint_h__
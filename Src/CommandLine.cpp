@@ -0,0 +1,611 @@
+/// \file CommandLine.cpp
+/// \brief Command line driver for verification, generation, and export.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cctype>
+#include <chrono>
+#include <clocale>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "Helpers.h"
+#include "NetworkContainer.h"
+#include "SortingNetwork.h"
+
+#include "Bubblesort.h"
+#include "OddEven.h"
+#include "Bitonic.h"
+#include "Pairwise.h"
+
+/// Exit code when every network sorts and every command succeeded.
+static const int EXIT_SORTS = 0;
+
+/// Exit code when some network doesn't sort.
+static const int EXIT_NOTSORTS = 1;
+
+/// Exit code for bad arguments or a file that can't be read or written.
+static const int EXIT_ERROR = 2;
+
+/// Print the usage message to `stderr`.
+
+static void Usage(){
+  fprintf(stderr,
+    "Usage: sncli COMMAND [OPTIONS] ARGS\n"
+    "Commands:\n"
+    "  verify FILE...           Verify the networks in text, comparator list,\n"
+    "                           binary, or container files\n"
+    "  generate KIND N OUT      Generate an N-input sorting network, where KIND\n"
+    "                           is bubble, bubblemin, bubblemax, oddeven,\n"
+    "                           bitonic, or pairwise\n"
+    "  prune N IN OUT           Prune a network down to N inputs\n"
+    "  relayer IN OUT           Move comparators to the earliest levels\n"
+    "  convert IN OUT           Convert between file formats\n"
+    "  export IN OUT            Same as convert, for .svg, .tex, and .png files\n"
+    "  pack OUT IN...           Put networks into a container file\n"
+    "  selftest FILE...         Check every lane kernel supported here against\n"
+    "                           the Gray code engine on each network\n"
+    "Output files ending in .snb are binary, .snc are containers, .svg, .tex,\n"
+    "and .png are drawings, and anything else is text. An input file can be\n"
+    "FILE[K] for the Kth network in a container, counting from 0, or just FILE\n"
+    "if it holds one network.\n"
+    "Options:\n"
+    "  -e ENGINE  Verification engine: graycode, bitsliced (default),\n"
+    "             parallel, reachable, dense, prefix, or incremental\n"
+    "  -t N       Number of threads for the parallel engine, 0 for all\n"
+    "  -c FILE    Checkpoint file, which selects the graycode engine\n"
+    "  -k N       Number of levels in the prefix, at most the depth, which\n"
+    "             selects the prefix engine, 0 to choose automatically\n"
+    "  -m         Report the counterexample with the fewest ones or zeros,\n"
+    "             which may take as long as verification\n"
+    "  -v         Draw vertically instead of horizontally\n"
+    "  -z         Write compact SVG, with each level as a path and repeated\n"
+    "             levels reused\n");
+} //Usage
+
+/// Convert a command line argument to a wide string in the current locale.
+/// \param s Null terminated multibyte string.
+/// \return Wide string, which is empty if the conversion failed.
+
+static std::wstring Widen(const char* s){
+  const size_t n = mbstowcs(nullptr, s, 0); //length of wide string
+  if(n == (size_t)-1)return std::wstring(); //bail and fail
+
+  std::wstring wstr(n, L'\0'); //wide string
+  mbstowcs(&wstr[0], s, n + 1);
+
+  return wstr;
+} //Widen
+
+/// Test whether a file name ends in a certain extension, ignoring case.
+/// \param strName File name.
+/// \param strExt Extension, including the dot.
+/// \return true if the file name ends in the extension.
+
+static bool HasExtension(const std::string& strName, const char* strExt){
+  const size_t n = strlen(strExt); //length of extension
+  if(strName.size() < n)return false; //too short
+
+  for(size_t i=0; i<n; i++) //compare characters from the end
+    if(tolower((unsigned char)strName[strName.size() - n + i]) != strExt[i])
+      return false;
+
+  return true;
+} //HasExtension
+
+/// Parse an unsigned integer from a command line argument.
+/// \param s Null terminated string.
+/// \param n [OUT] The integer.
+/// \return true if the whole string is an unsigned integer.
+
+static bool ParseUint(const char* s, UINT& n){
+  const char* p = s; //current character
+  const char* pEnd = s + strlen(s); //one past the last character
+  return ScanUint(p, pEnd, n) && p == pEnd;
+} //ParseUint
+
+/// Read a comparator network from a text, comparator list, binary, or
+/// container file, printing an error message if that fails. A network in a
+/// container file is named by its index in square brackets after the file
+/// name, counting from zero, as in `FILE.snc[3]`. The index can be left off
+/// if the container file holds only one network.
+/// \param strName File name, possibly followed by an index.
+/// \param net [OUT] Sorting network.
+/// \return true if it was read.
+
+static bool Load(const std::string& strName, CSortingNetwork& net){
+  std::string strFile = strName; //file name without the index
+  UINT k = 0; //index of network in container
+  bool bIndex = false; //whether there is an index
+
+  const size_t nOpen = strName.rfind('['); //start of index, if any
+
+  if(nOpen != std::string::npos && strName.back() == ']' &&
+    ParseUint(strName.substr(nOpen + 1, strName.size() - nOpen - 2).c_str(), k))
+  {
+    strFile = strName.substr(0, nOpen);
+    bIndex = true;
+  } //if
+
+  CContainerReader reader; //container file reader
+  bool ok = false; //success
+
+  if(reader.Open(Widen(strFile.c_str()).c_str())){ //container file
+    if(!bIndex && reader.GetCount() != 1){ //bail and fail
+      fprintf(stderr, "Cannot read %s, which holds %llu networks, use %s[K]\n",
+        strName.c_str(), (unsigned long long)reader.GetCount(), strName.c_str());
+      return false;
+    } //if
+
+    ok = reader.Read(k, net);
+  } //if
+
+  else ok = net.Read((LPWSTR)Widen(strName.c_str()).c_str());
+
+  if(!ok)fprintf(stderr, "Cannot read %s\n", strName.c_str());
+  return ok;
+} //Load
+
+/// Write a comparator network to a file in the format given by the file name
+/// extension, printing an error message if that fails.
+/// \param net Sorting network.
+/// \param strName File name.
+/// \param eStyle Draw style for SVG, TeX, and PNG files.
+/// \param bCompact Whether SVG files are compact.
+/// \return true if it was written.
+
+static bool Save(CSortingNetwork& net, const std::string& strName,
+  const eDrawStyle eStyle, const bool bCompact)
+{
+  std::wstring wstrName = Widen(strName.c_str()); //wide file name
+  LPWSTR lpwstr = (LPWSTR)wstrName.c_str(); //wide file name as a pointer
+  bool ok = false; //success
+
+  net.SetDrawStyle(eStyle);
+  net.SetCompactSVG(bCompact);
+
+  if(HasExtension(strName, ".svg"))
+    ok = SUCCEEDED(net.ExportToSVG(lpwstr));
+
+  else if(HasExtension(strName, ".tex"))
+    ok = SUCCEEDED(net.ExportToTex(lpwstr));
+
+  else if(HasExtension(strName, ".png"))
+    ok = SUCCEEDED(net.RasterizeToPNG(lpwstr));
+
+  else if(HasExtension(strName, ".snb"))
+    ok = net.WriteBinary(lpwstr);
+
+  else if(HasExtension(strName, ".snc")){ //container with one network
+    CContainerWriter writer; //container file writer
+    ok = writer.Open(lpwstr) && writer.Append(net);
+    ok = writer.Close() && ok;
+  } //else if
+
+  else ok = net.WriteText(lpwstr);
+
+  if(!ok)fprintf(stderr, "Cannot write %s\n", strName.c_str());
+  return ok;
+} //Save
+
+/// Check that a comparator network is deep enough for the number of levels
+/// in the prefix given with `-k`, printing an error message if it isn't.
+/// \param strName File name.
+/// \param net Sorting network.
+/// \param nPrefix Number of levels in the prefix, or zero for automatic.
+/// \return true if the prefix is no deeper than the comparator network.
+
+static bool CheckPrefix(const std::string& strName, const CSortingNetwork& net,
+  const UINT nPrefix)
+{
+  const bool ok = nPrefix <= net.GetDepth();
+  if(!ok)fprintf(stderr, "Prefix of %u levels is deeper than %s\n", nPrefix,
+    strName.c_str());
+  return ok;
+} //CheckPrefix
+
+/// Describe an amount of memory in the largest unit that keeps it a
+/// whole number.
+/// \param n Number of bytes.
+/// \return Description, for example "128 MB".
+
+static std::string Bytes(UINT64 n){
+  const char* strUnit[] = {"bytes", "KB", "MB", "GB"}; //units
+  UINT u = 0; //index of unit
+
+  while(u < 3 && n >= 1024 && n%1024 == 0){
+    n /= 1024;
+    ++u;
+  } //while
+
+  return std::to_string(n) + " " + strUnit[u];
+} //Bytes
+
+/// Verify a sorting network and print one line describing the result, in
+/// the same terms as the Verify dialog box of the Windows version. For the
+/// dense engine, also print how much memory the bitmap needs, and for any
+/// engine that falls back to the bit-sliced one, say so.
+/// \param strName Name to print at the start of the line.
+/// \param net Sorting network.
+/// \param bMinimize Whether to minimize the counterexample, if any.
+/// \return true if it sorts.
+
+static bool Verify(const std::string& strName, CSortingNetwork& net,
+  const bool bMinimize)
+{
+  const auto tStart = std::chrono::steady_clock::now(); //start time
+  const bool bSorts = net.sorts(); //the heavy lifting
+  const std::chrono::duration<double> tElapsed =
+    std::chrono::steady_clock::now() - tStart; //elapsed time
+
+  printf("%s: %u inputs, depth %u, size %u, ", strName.c_str(),
+    net.GetNumInputs(), net.GetDepth(), net.GetSize());
+
+  if(bSorts)
+    printf("sorts, %u redundant", net.GetUnused());
+
+  else{
+    printf("does not sort");
+    CCounterexample c; //input that isn't sorted
+    if(bMinimize)net.MinimizeCounterexample();
+
+    if(net.GetCounterexample(c)){
+      std::string strInput, strOutput; //input and output as bit strings
+
+      for(UINT j=0; j<c.m_vInput.size(); j++){
+        strInput += std::to_string(c.m_vInput[j]);
+        strOutput += std::to_string(c.m_vOutput[j]);
+      } //for
+
+      printf(", %s -> %s stranded after %u level%s", strInput.c_str(),
+        strOutput.c_str(), c.m_nLevel, (c.m_nLevel == 1)? "": "s");
+    } //if
+  } //else
+
+  printf(", %sfirst normal form", net.FirstNormalForm()? "": "not ");
+
+  if(net.GetVerify() == eVerify::DenseBitmap){
+    const UINT64 nBytes = net.GetBitmapBytes(); //memory for bitmap
+    if(nBytes == 0)printf(", too many inputs for a dense bitmap");
+    else printf(", dense bitmap %s", Bytes(nBytes).c_str());
+  } //if
+
+  if(net.GetVerified() != net.GetVerify())
+    printf(", fell back to bitsliced");
+
+  printf(", %0.3fs\n", tElapsed.count());
+
+  return bSorts;
+} //Verify
+
+/// Generate a sorting network. The odd-even, bitonic, and pairwise sorting
+/// networks are generated for the next power of 2 and pruned, as in the
+/// Windows version.
+/// \param strKind Kind of sorting network.
+/// \param n Number of inputs.
+/// \return Pointer to the sorting network, or nullptr if the kind is unknown.
+
+static CSortingNetwork* Generate(const std::string& strKind, const UINT n){
+  CSortingNetwork* p = nullptr; //the sorting network
+
+  if(strKind == "bubble")p = new CBubbleSort(n);
+  else if(strKind == "bubblemin")p = new CBubbleSortMin(n);
+  else if(strKind == "bubblemax")p = new CBubbleSortMax(n);
+
+  else{
+    if(strKind == "oddeven")p = new COddEvenSort(CeilLog2(n));
+    else if(strKind == "bitonic")p = new CBitonicSort(CeilLog2(n));
+    else if(strKind == "pairwise")p = new CPairwiseSort(CeilLog2(n));
+
+    if(p && !IsPowerOf2(n))p->Prune(n); //prune unneeded channels and comparators
+  } //else
+
+  return p;
+} //Generate
+
+/// Parse the options, run a command, and report the result.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return `EXIT_SORTS` if it succeeded and every network verified sorts,
+/// `EXIT_NOTSORTS` if some network doesn't sort or fails the self test, or
+/// `EXIT_ERROR`.
+
+static int Run(int argc, char* argv[]){
+
+  eVerify eEngine = eVerify::BitSliced; //verification engine
+  bool bEngine = false; //whether the engine was chosen with -e
+  eDrawStyle eStyle = eDrawStyle::Horizontal; //draw style
+  bool bCompact = false; //whether SVG is compact
+  bool bMinimize = false; //whether to minimize counterexamples
+  UINT nThreads = 0; //number of threads for parallel engine
+  UINT nPrefix = 0; //number of levels in prefix for prefix engine
+  bool bPrefix = false; //whether the prefix was given with -k
+  std::wstring wstrCheckpoint; //checkpoint file name
+  std::vector<std::string> vecArg; //arguments other than options
+
+  //parse options
+
+  for(int i=1; i<argc; i++){ //for each argument
+    const std::string strArg = argv[i]; //the argument
+
+    if(strArg == "-v")eStyle = eDrawStyle::Vertical;
+    else if(strArg == "-z")bCompact = true;
+    else if(strArg == "-m")bMinimize = true;
+
+    else if(strArg == "-e" && i + 1 < argc){
+      const std::string s = argv[++i]; //engine name
+      bEngine = true;
+
+      if(s == "graycode")eEngine = eVerify::GrayCode;
+      else if(s == "bitsliced")eEngine = eVerify::BitSliced;
+      else if(s == "parallel")eEngine = eVerify::Parallel;
+      else if(s == "reachable")eEngine = eVerify::ReachableSet;
+      else if(s == "dense")eEngine = eVerify::DenseBitmap;
+      else if(s == "prefix")eEngine = eVerify::Prefix;
+      else if(s == "incremental")eEngine = eVerify::Incremental;
+
+      else{ //bail and fail
+        fprintf(stderr, "Unknown engine %s\n", s.c_str());
+        return EXIT_ERROR;
+      } //else
+    } //else if
+
+    else if(strArg == "-t" && i + 1 < argc){
+      if(!ParseUint(argv[++i], nThreads)){ //bail and fail
+        Usage();
+        return EXIT_ERROR;
+      } //if
+    } //else if
+
+    else if(strArg == "-k" && i + 1 < argc){
+      if(!ParseUint(argv[++i], nPrefix)){ //bail and fail
+        Usage();
+        return EXIT_ERROR;
+      } //if
+
+      bPrefix = true;
+    } //else if
+
+    else if(strArg == "-c" && i + 1 < argc)
+      wstrCheckpoint = Widen(argv[++i]);
+
+    else if(strArg.size() > 1 && strArg[0] == '-'){ //bail and fail
+      Usage();
+      return EXIT_ERROR;
+    } //else if
+
+    else vecArg.push_back(strArg);
+  } //for
+
+  if(vecArg.empty()){ //bail and fail
+    Usage();
+    return EXIT_ERROR;
+  } //if
+
+  //only the Gray code engine checkpoints
+
+  if(!wstrCheckpoint.empty()){
+    if(!bEngine)eEngine = eVerify::GrayCode;
+
+    else if(eEngine != eVerify::GrayCode){ //bail and fail
+      fprintf(stderr, "Checkpoints need the graycode engine\n");
+      return EXIT_ERROR;
+    } //else if
+  } //if
+
+  //only the prefix engine has a prefix
+
+  if(bPrefix){
+    if(!bEngine)eEngine = eVerify::Prefix;
+
+    else if(eEngine != eVerify::Prefix){ //bail and fail
+      fprintf(stderr, "A prefix needs the prefix engine\n");
+      return EXIT_ERROR;
+    } //else if
+  } //if
+
+  const std::string strCmd = vecArg[0]; //command
+  const size_t nArgs = vecArg.size() - 1; //number of arguments to command
+  UINT n = 0; //number of inputs, if any
+
+  //verify
+
+  if(strCmd == "verify" && nArgs >= 1){
+    int nResult = EXIT_SORTS; //result so far
+
+    for(size_t i=1; i<=nArgs; i++){ //for each file
+      const std::string& strName = vecArg[i]; //file name
+      CContainerReader reader; //container file reader
+      CSortingNetwork net; //sorting network
+
+      net.SetVerify(eEngine);
+      net.SetThreads(nThreads);
+      net.SetPrefix(nPrefix);
+      if(!wstrCheckpoint.empty())net.SetCheckpoint(wstrCheckpoint);
+
+      if(reader.Open(Widen(strName.c_str()).c_str())){ //container file
+        for(UINT64 k=0; k<reader.GetCount(); k++){ //for each network in it
+          const std::string strLabel = strName + "[" + std::to_string(k) + "]";
+
+          if(!reader.Next(net)){
+            fprintf(stderr, "Cannot read %s\n", strLabel.c_str());
+            nResult = EXIT_ERROR;
+          } //if
+
+          else if(!CheckPrefix(strLabel, net, nPrefix))
+            nResult = EXIT_ERROR;
+
+          else if(!Verify(strLabel, net, bMinimize) && nResult == EXIT_SORTS)
+            nResult = EXIT_NOTSORTS;
+        } //for
+      } //if
+
+      else if(!Load(strName, net) || !CheckPrefix(strName, net, nPrefix))
+        nResult = EXIT_ERROR;
+
+      else if(!Verify(strName, net, bMinimize) && nResult == EXIT_SORTS)
+        nResult = EXIT_NOTSORTS;
+    } //for
+
+    return nResult;
+  } //if
+
+  //generate
+
+  else if(strCmd == "generate" && nArgs == 3){
+    if(!ParseUint(vecArg[2].c_str(), n) || n < 2){ //bail and fail
+      fprintf(stderr, "Bad number of inputs %s\n", vecArg[2].c_str());
+      return EXIT_ERROR;
+    } //if
+
+    std::unique_ptr<CSortingNetwork> p(Generate(vecArg[1], n)); //the network
+
+    if(p == nullptr){ //bail and fail
+      fprintf(stderr, "Unknown kind of sorting network %s\n", vecArg[1].c_str());
+      return EXIT_ERROR;
+    } //if
+
+    return Save(*p, vecArg[3], eStyle, bCompact)? EXIT_SORTS: EXIT_ERROR;
+  } //else if
+
+  //prune
+
+  else if(strCmd == "prune" && nArgs == 3){
+    CSortingNetwork net; //sorting network
+
+    if(!ParseUint(vecArg[1].c_str(), n) || n < 2){ //bail and fail
+      fprintf(stderr, "Bad number of inputs %s\n", vecArg[1].c_str());
+      return EXIT_ERROR;
+    } //if
+
+    if(!Load(vecArg[2], net))return EXIT_ERROR; //bail and fail
+    net.Prune(n);
+
+    return Save(net, vecArg[3], eStyle, bCompact)? EXIT_SORTS: EXIT_ERROR;
+  } //else if
+
+  //relayer
+
+  else if(strCmd == "relayer" && nArgs == 2){
+    CSortingNetwork net; //sorting network
+    UINT nOldDepth = 0, nNewDepth = 0; //depth before and after
+
+    if(!Load(vecArg[1], net))return EXIT_ERROR; //bail and fail
+    net.Relayer(nOldDepth, nNewDepth);
+    printf("%s: depth %u -> %u\n", vecArg[1].c_str(), nOldDepth, nNewDepth);
+
+    return Save(net, vecArg[2], eStyle, bCompact)? EXIT_SORTS: EXIT_ERROR;
+  } //else if
+
+  //convert or export
+
+  else if((strCmd == "convert" || strCmd == "export") && nArgs == 2){
+    CSortingNetwork net; //sorting network
+    if(!Load(vecArg[1], net))return EXIT_ERROR; //bail and fail
+    return Save(net, vecArg[2], eStyle, bCompact)? EXIT_SORTS: EXIT_ERROR;
+  } //else if
+
+  //pack
+
+  else if(strCmd == "pack" && nArgs >= 2){
+    CContainerWriter writer; //container file writer
+
+    if(!writer.Open(Widen(vecArg[1].c_str()).c_str())){ //bail and fail
+      fprintf(stderr, "Cannot write %s\n", vecArg[1].c_str());
+      return EXIT_ERROR;
+    } //if
+
+    for(size_t i=2; i<=nArgs; i++){ //for each input file
+      CSortingNetwork net; //sorting network
+
+      if(!Load(vecArg[i], net) || !writer.Append(net)){ //bail and fail
+        writer.Close();
+        return EXIT_ERROR;
+      } //if
+    } //for
+
+    if(!writer.Close()){ //bail and fail
+      fprintf(stderr, "Cannot write %s\n", vecArg[1].c_str());
+      return EXIT_ERROR;
+    } //if
+
+    return EXIT_SORTS;
+  } //else if
+
+  //self test
+
+  else if(strCmd == "selftest" && nArgs >= 1){
+    int nResult = EXIT_SORTS; //result so far
+
+    printf("Lane kernels:");
+
+    for(eKernel k: {eKernel::Scalar, eKernel::Avx2, eKernel::Avx512})
+      if(KernelSupported(k))
+        printf(" %s", KernelName(k).c_str());
+
+    printf("\n");
+
+    for(size_t i=1; i<=nArgs; i++){ //for each file
+      CSortingNetwork net; //sorting network
+
+      if(!Load(vecArg[i], net))
+        nResult = EXIT_ERROR;
+
+      else if(net.SelfTest())
+        printf("%s: passed\n", vecArg[i].c_str());
+
+      else{ //some kernel disagrees with the Gray code engine
+        printf("%s: FAILED\n", vecArg[i].c_str());
+        if(nResult == EXIT_SORTS)nResult = EXIT_NOTSORTS;
+      } //else
+    } //for
+
+    return nResult;
+  } //else if
+
+  Usage();
+  return EXIT_ERROR;
+} //Run
+
+/// Set the locale and run the command line, reporting running out of memory
+/// as an error rather than aborting. Only the character type comes from the
+/// user's locale, since file names are in it, so that the numbers written
+/// to SVG and TeX files keep their decimal points.
+/// \param argc Number of arguments.
+/// \param argv Arguments.
+/// \return `EXIT_SORTS`, `EXIT_NOTSORTS`, or `EXIT_ERROR` as for `Run()`.
+
+int main(int argc, char* argv[]){
+  setlocale(LC_CTYPE, ""); //file names are in the user's locale
+
+  try{
+    return Run(argc, argv);
+  } //try
+
+  catch(const std::bad_alloc&){
+    fprintf(stderr, "Out of memory\n");
+    return EXIT_ERROR;
+  } //catch
+} //main
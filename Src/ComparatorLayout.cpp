@@ -0,0 +1,243 @@
+/// \file ComparatorLayout.cpp
+/// \brief Code for the comparator layout CComparatorLayout.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+
+#include "ComparatorLayout.h"
+
+/// Double the number of leaves in the min-tree `m_vecTree`. The old leaves
+/// are moved to the left half of the new ones, the new leaves in the right
+/// half are set to the largest `UINT`, and the internal nodes are
+/// recomputed.
+/// \param nLeaves [IN, OUT] Number of leaves.
+
+void CComparatorLayout::GrowTree(UINT& nLeaves){
+  m_vecTree.resize(4*nLeaves, UINT(-1));
+  std::copy(m_vecTree.begin() + nLeaves, m_vecTree.begin() + 2*nLeaves,
+    m_vecTree.begin() + 2*nLeaves);
+  std::fill(m_vecTree.begin() + 3*nLeaves, m_vecTree.end(), UINT(-1));
+  nLeaves *= 2;
+
+  for(UINT nNode=nLeaves-1; nNode>0; nNode--)
+    m_vecTree[nNode] = min(m_vecTree[2*nNode], m_vecTree[2*nNode + 1]);
+} //GrowTree
+
+/// Divide the comparators at a level into passes. Each comparator in scan
+/// order is put into the first pass whose last comparator ends before it
+/// starts. The far end of the last comparator in each pass is kept in the
+/// leaves of a min-tree `m_vecTree`, with unused passes set to the largest
+/// `UINT` so that nothing fits into them, and the first pass that fits is
+/// found by walking down from the root. The tree starts with one leaf and
+/// doubles whenever it runs out, so its height is the log of the number of
+/// passes, which is usually small. In horizontal draw style the channels
+/// are complemented so that the scan is in increasing order in both draw
+/// styles. With `k` comparators at the level, this takes O(k log k) time
+/// instead of the O(k) time per comparator needed to try each pass in turn.
+/// The comparators in scan order are put into `m_vecScan` and their passes
+/// into `m_vecPass`.
+/// \param v Comparators at the level in increasing order of min channel.
+/// \param eStyle Draw style, which determines the scan order.
+/// \return Number of passes.
+
+UINT CComparatorLayout::LayoutLevel(
+  const std::vector<CComparator>& v, const eDrawStyle eStyle)
+{
+  const bool bDown = eStyle == eDrawStyle::Horizontal; //scan in decreasing order
+  const UINT k = (UINT)v.size(); //number of comparators
+  m_vecScan = v;
+
+  if(bDown) //scan in decreasing order of max channel
+    std::sort(m_vecScan.begin(), m_vecScan.end(),
+      [](const CComparator& a, const CComparator& b){
+        return a.m_nMax > b.m_nMax;});
+
+  UINT nLeaves = 1; //number of leaves in the min-tree
+  m_vecTree.assign(2*nLeaves, UINT(-1)); //no passes yet
+  m_vecPass.resize(k);
+
+  UINT nPasses = 0; //number of passes so far
+
+  for(UINT c=0; c<k; c++){ //for each comparator in scan order
+    const CComparator& p = m_vecScan[c]; //the comparator
+    const UINT nNear = bDown? ~p.m_nMax: p.m_nMin; //end reached first in scan
+    const UINT nFar  = bDown? ~p.m_nMin: p.m_nMax; //end reached last in scan
+    UINT nNode = 1; //root of the min-tree
+
+    if(m_vecTree[1] < nNear){ //fits into an existing pass
+      while(nNode < nLeaves) //walk down to the leftmost leaf that fits
+        nNode = 2*nNode + (m_vecTree[2*nNode] < nNear? 0: 1);
+      m_vecPass[c] = nNode - nLeaves;
+    } //if
+
+    else{ //new pass
+      if(nPasses == nLeaves)GrowTree(nLeaves);
+      m_vecPass[c] = nPasses++;
+      nNode = nLeaves + m_vecPass[c];
+    } //else
+
+    m_vecTree[nNode] = nFar;
+
+    for(nNode >>= 1; nNode > 0; nNode >>= 1){ //update the path to the root
+      const UINT nMin = min(m_vecTree[2*nNode], m_vecTree[2*nNode + 1]);
+      if(m_vecTree[nNode] == nMin)break; //nothing more changes
+      m_vecTree[nNode] = nMin;
+    } //for
+  } //for
+
+  return nPasses;
+} //LayoutLevel
+
+/// Build the layout of a comparator network in a draw style. Each level is
+/// divided into passes by `LayoutLevel()` and its comparators are then
+/// put into `m_vecComparator` grouped by pass using a counting sort, which
+/// keeps them in scan order within each pass. Takes O(s log n) time for a
+/// comparator network of size `s` with `n` inputs.
+/// \param cNet Comparator network.
+/// \param eStyle Draw style.
+
+void CComparatorLayout::Build(
+  const CComparatorNetwork& cNet, const eDrawStyle eStyle)
+{
+  const UINT nDepth = cNet.GetDepth();
+
+  m_vecLevelStart.assign(1, 0);
+  m_vecPassStart.assign(1, 0);
+  m_vecComparator.assign(cNet.GetSize(), CComparator(0, 0));
+
+  UINT nNext = 0; //index of next comparator in m_vecComparator
+
+  for(UINT i=0; i<nDepth; i++){ //for each level
+    const UINT nPasses = LayoutLevel(cNet.GetLevel(i), eStyle);
+    const UINT nFirst = (UINT)m_vecPassStart.size() - 1; //index of first pass
+
+    m_vecPassStart.resize(nFirst + nPasses + 1, 0);
+
+    for(UINT c=0; c<m_vecScan.size(); c++) //count comparators in each pass
+      m_vecPassStart[nFirst + m_vecPass[c] + 1]++;
+
+    m_vecPassStart[nFirst] = nNext;
+
+    for(UINT pass=0; pass<nPasses; pass++) //convert counts to start indices
+      m_vecPassStart[nFirst + pass + 1] += m_vecPassStart[nFirst + pass];
+
+    for(UINT c=0; c<m_vecScan.size(); c++) //place comparators in pass order
+      m_vecComparator[m_vecPassStart[nFirst + m_vecPass[c]]++] = m_vecScan[c];
+
+    for(UINT pass=nPasses; pass>0; pass--) //undo the increments
+      m_vecPassStart[nFirst + pass] = m_vecPassStart[nFirst + pass - 1];
+
+    m_vecPassStart[nFirst] = nNext;
+    nNext += (UINT)m_vecScan.size();
+    m_vecLevelStart.push_back(nFirst + nPasses);
+  } //for
+
+  m_nRevision = cNet.GetRevision();
+  m_bDown = eStyle == eDrawStyle::Horizontal;
+  m_bValid = true;
+} //Build
+
+/// Mark the layout as needing to be built, for example when it is about
+/// to be used for a different comparator network.
+
+void CComparatorLayout::Invalidate(){
+  m_bValid = false;
+} //Invalidate
+
+/// Test whether the layout has been built and the comparator network hasn't
+/// changed since. This is only meaningful for the comparator network
+/// that it was built from.
+/// \param cNet Comparator network.
+/// \return True if the layout can be used without building it again.
+
+const bool CComparatorLayout::IsCurrent(const CComparatorNetwork& cNet) const{
+  return m_bValid && m_nRevision == cNet.GetRevision();
+} //IsCurrent
+
+/// Reader function for the number of levels laid out.
+/// \return Number of levels.
+
+const UINT CComparatorLayout::GetDepth() const{
+  return (UINT)m_vecLevelStart.size() - 1;
+} //GetDepth
+
+/// Reader function for the number of passes at a level.
+/// \param i Level.
+/// \return Number of passes at level `i`.
+
+const UINT CComparatorLayout::GetPasses(const UINT i) const{
+  return m_vecLevelStart[i + 1] - m_vecLevelStart[i];
+} //GetPasses
+
+/// Reader function for the comparators in a pass, which are in scan order.
+/// \param i Level.
+/// \param pass Pass at level `i`.
+/// \param n [OUT] Number of comparators in the pass.
+/// \return Pointer to the first comparator in the pass.
+
+const CComparator* CComparatorLayout::GetPass(
+  const UINT i, const UINT pass, UINT& n) const
+{
+  const UINT q = m_vecLevelStart[i] + pass; //index of pass
+  n = m_vecPassStart[q + 1] - m_vecPassStart[q];
+  return m_vecComparator.data() + m_vecPassStart[q];
+} //GetPass
+
+/// Reader function for the comparators in a pass that reach a range of
+/// channels, that is, the ones whose channels overlap `[lo, hi]`. Since the
+/// comparators in a pass don't overlap each other and are in scan order,
+/// these are consecutive and can be found by binary search.
+/// \param i Level.
+/// \param pass Pass at level `i`.
+/// \param lo Lowest channel in the range.
+/// \param hi Highest channel in the range.
+/// \param n [OUT] Number of comparators in the pass that reach the range.
+/// \return Pointer to the first of them in scan order.
+
+const CComparator* CComparatorLayout::GetPass(const UINT i, const UINT pass,
+  const UINT lo, const UINT hi, UINT& n) const
+{
+  UINT nAll = 0; //number of comparators in the pass
+  const CComparator* pBegin = GetPass(i, pass, nAll);
+  const CComparator* pEnd = pBegin + nAll;
+  const CComparator* pFirst = nullptr; //first one in range
+  const CComparator* pLast = nullptr; //one past the last one in range
+
+  if(m_bDown){ //decreasing order
+    pFirst = std::partition_point(pBegin, pEnd,
+      [hi](const CComparator& c){return c.m_nMin > hi;});
+    pLast = std::partition_point(pFirst, pEnd,
+      [lo](const CComparator& c){return c.m_nMax >= lo;});
+  } //if
+
+  else{ //increasing order
+    pFirst = std::partition_point(pBegin, pEnd,
+      [lo](const CComparator& c){return c.m_nMax < lo;});
+    pLast = std::partition_point(pFirst, pEnd,
+      [hi](const CComparator& c){return c.m_nMin <= hi;});
+  } //else
+
+  n = (UINT)(pLast - pFirst);
+  return pFirst;
+} //GetPass
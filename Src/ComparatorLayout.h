@@ -0,0 +1,79 @@
+/// \file ComparatorLayout.h
+/// \brief Interface for the comparator layout CComparatorLayout.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __ComparatorLayout_h__
+#define __ComparatorLayout_h__
+
+#include "Platform.h"
+#include "Defines.h"
+#include "ComparatorNetwork.h"
+
+/// \brief Comparator layout.
+///
+/// The comparators at a level of a comparator network can't all be drawn
+/// in the same column if they overlap, so each level is divided into passes
+/// (sub-columns) that are drawn one after the other. The channels are
+/// scanned in increasing order in vertical draw style and in decreasing
+/// order in horizontal draw style, and each comparator goes into the first
+/// pass in which it doesn't overlap the comparator last put there. 
+/// `CComparatorLayout` records the result for every level in one draw style,
+/// with the comparators grouped by pass and in scan order within each pass,
+/// so that a renderer can simply walk through it. It also records the
+/// revision number of the comparator network that it was built from so
+/// that it can be reused until the comparator network changes. Since the
+/// comparators in a pass don't overlap and are in scan order, the ones that
+/// reach a range of channels can be found by binary search, which lets a
+/// tiled renderer skip the rest.
+
+class CComparatorLayout{
+  private:
+    bool m_bValid = false; ///< True if it has been built.
+    UINT64 m_nRevision = 0; ///< Revision of the comparator network laid out.
+    bool m_bDown = false; ///< True if channels were scanned in decreasing order.
+
+    std::vector<UINT> m_vecLevelStart; ///< Index of first pass at each level.
+    std::vector<UINT> m_vecPassStart; ///< Index of first comparator in each pass.
+    std::vector<CComparator> m_vecComparator; ///< Comparators in draw order.
+
+    std::vector<CComparator> m_vecScan; ///< Scratch comparators in scan order.
+    std::vector<UINT> m_vecPass; ///< Scratch pass for each of them.
+    std::vector<UINT> m_vecTree; ///< Scratch min-tree of pass ends.
+
+    void GrowTree(UINT&); ///< Double the number of leaves in the min-tree.
+    UINT LayoutLevel(const std::vector<CComparator>&, const eDrawStyle); ///< Lay out a level.
+
+  public:
+    void Build(const CComparatorNetwork&, const eDrawStyle); ///< Build layout.
+    void Invalidate(); ///< Mark as needing to be built.
+    const bool IsCurrent(const CComparatorNetwork&) const; ///< Test if up to date.
+
+    const UINT GetDepth() const; ///< Get number of levels.
+    const UINT GetPasses(const UINT) const; ///< Get number of passes at a level.
+    const CComparator* GetPass(const UINT, const UINT, UINT&) const; ///< Get a pass.
+    const CComparator* GetPass(const UINT, const UINT, const UINT, const UINT,
+      UINT&) const; ///< Get the part of a pass in a range of channels.
+}; //CComparatorLayout
+
+#endif //__ComparatorLayout_h__
@@ -23,107 +23,583 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <fstream>
-#include <sstream>
-#include <string>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 
-#include "Includes.h"
+#include "Platform.h"
 #include "Helpers.h"
 #include "ComparatorNetwork.h"
-
-/// Delete the memory used for the 2D array `m_nMatch`.
-
-CComparatorNetwork::~CComparatorNetwork(){
-  if(m_nMatch){ //safety
-    for(UINT i=0; i<m_nDepth; i++)
-      delete [] m_nMatch[i];
-    delete [] m_nMatch;
-  } //if
-} //destructor
-
-/// Read a comparator network from file. Create and input the matching array
-/// `m_nMatch` and set `m_nInputs` to the number of inputs, `m_nDepth` to the
-/// depth, and `m_nSize` to the size (number of comparators). The input file
-/// must consist of a line of text for each layer of comparators. Each line
-/// must consist of an even number of unsigned integer channel numbers in which
-/// each consecutive pair \f$i, j\f$ indicates a comparator between channels
-/// \f$i\f$ and \f$j\f$.
+#include "MappedFile.h"
+#include "NetworkContainer.h"
+
+static const UINT g_nMagic = 0x4E424E53; ///< "SNBN" for sorting network binary.
+static const UINT g_nVersion = 1; ///< Binary file format version.
+static const BYTE FLAG_FIRSTNORMALFORM = 1; ///< Header flag for first normal form.
+
+/// \brief Header of a binary comparator network file.
+///
+/// The fields are laid out so that there is no padding, and the header is
+/// copied to and from the file as is.
+
+struct CBinaryHeader{
+  UINT m_nMagic = 0; ///< Magic number.
+  UINT m_nVersion = 0; ///< File format version.
+  UINT m_nInputs = 0; ///< Number of inputs.
+  UINT m_nDepth = 0; ///< Depth.
+  UINT m_nSize = 0; ///< Size.
+  BYTE m_nFlags = 0; ///< Flags.
+  BYTE m_nWidth = 0; ///< Number of bytes per channel index.
+  UINT16 m_nReserved = 0; ///< Reserved, always zero.
+  UINT64 m_nHash = 0; ///< Hash of the comparator network.
+}; //CBinaryHeader
+
+static_assert(sizeof(CBinaryHeader) == 32, "CBinaryHeader must have no padding");
+
+/// Get the number of bytes needed for a channel index in a binary file,
+/// which is the same as the width of the entries in the matching array.
+/// \param nInputs Number of inputs.
+/// \return 1, 2, or 4.
+
+static UINT GetIndexBytes(const UINT nInputs){
+  switch(CMatchArray::ChooseWidth(nInputs)){
+    case eIndexWidth::Bits8:  return 1;
+    case eIndexWidth::Bits16: return 2;
+    default:                  return 4;
+  } //switch
+} //GetIndexBytes
+
+/// Get a little-endian unsigned integer from a byte buffer.
+/// \param p Pointer to the first byte.
+/// \param w Number of bytes, 1, 2, or 4.
+/// \return The integer.
+
+static UINT GetIndex(const BYTE* p, const UINT w){
+  switch(w){
+    case 1:  return p[0];
+    case 2:  return p[0] | (UINT)p[1] << 8;
+    default: return p[0] | (UINT)p[1] << 8 | (UINT)p[2] << 16 | (UINT)p[3] << 24;
+  } //switch
+} //GetIndex
+
+/// Put a little-endian unsigned integer into a byte buffer.
+/// \param p Pointer to the first byte.
+/// \param n The integer.
+/// \param w Number of bytes, 1, 2, or 4.
+
+static void PutIndex(BYTE* p, const UINT n, const UINT w){
+  for(UINT k=0; k<w; k++) //for each byte
+    p[k] = (BYTE)(n >> (8*k));
+} //PutIndex
+
+/// Compare the min channel of a comparator to a channel index, for binary
+/// search in a comparator list.
+/// \param c A comparator.
+/// \param n A channel index.
+/// \return true if the min channel of the comparator is less than n.
+
+static bool LessMin(const CComparator& c, const UINT n){
+  return c.m_nMin < n;
+} //LessMin
+
+/// Find the end of a line of text.
+/// \param p Pointer to the first character of the line.
+/// \param pEnd Pointer to one past the last character of the text.
+/// \return Pointer to the newline at the end of the line, or pEnd if none.
+
+static const char* EndOfLine(const char* p, const char* pEnd){
+  const char* q = (const char*)memchr(p, '\n', pEnd - p); //newline
+  return q? q: pEnd;
+} //EndOfLine
+
+/// Test whether text is a comparator list, that is, whether its first
+/// character other than white space is an opening bracket, parenthesis, or
+/// brace.
+/// \param pBegin Pointer to the first character.
+/// \param pEnd Pointer to one past the last character.
+/// \return true if the text is a comparator list.
+
+static bool IsList(const char* pBegin, const char* pEnd){
+  const char* p = pBegin; //current character
+  while(p < pEnd && isspace((unsigned char)*p))p++; //skip white space
+  return p < pEnd && (*p == '[' || *p == '(' || *p == '{');
+} //IsList
+
+/// Scan the next unsigned integer from text, skipping anything before it
+/// that isn't a digit.
+/// \param p [IN, OUT] Pointer to the current character, advanced past the integer.
+/// \param pEnd Pointer to one past the last character.
+/// \param n [OUT] The integer.
+/// \return true if an integer was found.
+
+static bool NextUint(const char*& p, const char* pEnd, UINT& n){
+  while(p < pEnd && (*p < '0' || *p > '9'))p++; //skip separators
+  return ScanUint(p, pEnd, n);
+} //NextUint
+
+/// Read a comparator network from a text, comparator list, or binary file.
+/// The file is memory-mapped and parsed in place by `ReadImage()`.
 /// \param lpwstr Null terminated wide file name.
 /// \return true if the input succeeded.
 
 bool CComparatorNetwork::Read(LPWSTR lpwstr){
-  std::ifstream infile(lpwstr); //input file stream
-  bool bSuccess = (bool)infile; //should always be true
+  CMappedFile file; //input file
+  if(!file.Open(lpwstr))return false; //bail and fail
 
-  if(bSuccess){
-    const UINT nOldDepth = m_nDepth; //old depth 
+  return ReadImage(file.GetData(), file.GetSize());
+} //Read
 
-    UINT nInputs = 0; //number of inputs seen so far
-    UINT nDepth = 0; //depth seen so far
-    UINT nSize = 0; //number of comparators seen so far
+/// Read a comparator network from the contents of a text, comparator list,
+/// or binary file. A binary file starts with a magic number, and a
+/// comparator list starts with an opening bracket, parenthesis, or brace,
+/// whereas a text file starts with a digit. A container file holds many
+/// comparator networks and must be read with `CContainerReader`, so it is
+/// refused here rather than being parsed as text.
+/// \param p Pointer to the file contents.
+/// \param n Size of the file contents in bytes.
+/// \return true if the input succeeded.
 
-    std::vector<std::vector<UINT>> vMatching; //unprocessed matchings from input
-    std::string strLine; //current input line
-    std::vector<UINT> vEmptyVec; //the empty vector
+bool CComparatorNetwork::ReadImage(const BYTE* p, const size_t n){
+  const char* pBegin = (const char*)p; //first character
+  const char* pEnd = pBegin + n; //one past the last character
+
+  if(CContainerReader::IsContainerImage(p, n))
+    return false; //bail and fail
+
+  else if(IsBinaryImage(p, n))
+    return ReadBinary(p, n);
+
+  else if(IsList(pBegin, pEnd))
+    return ReadList(pBegin, pEnd);
+
+  else return ReadText(pBegin, pEnd);
+} //ReadImage
+
+/// Read a comparator network from text. Create and input the matching array
+/// `m_nMatch` and the comparator lists `m_vecLevel`, and set `m_nInputs` to
+/// the number of inputs, `m_nDepth` to the depth, and `m_nSize` to the size
+/// (number of comparators). The text must consist of a line for each layer
+/// of comparators. Each line must consist of an even number of unsigned
+/// integer channel numbers in which each consecutive pair \f$i, j\f$
+/// indicates a comparator between channels \f$i\f$ and \f$j\f$. Anything on
+/// a line after the last whole pair is ignored. The text is parsed in place
+/// with `ScanUint()` in two passes, the first to find the number of inputs
+/// and the depth so that the matching array can be created, and the second
+/// to insert the comparators into it. Nothing is copied on the way.
+/// \param pBegin Pointer to the first character.
+/// \param pEnd Pointer to one past the last character.
+/// \return true if the input succeeded.
 
-    //load vMatching from file
+bool CComparatorNetwork::ReadText(const char* pBegin, const char* pEnd){
+  UINT nInputs = 0; //number of inputs seen so far
+  UINT nDepth = 0; //depth seen so far
+  UINT a, b; //pair of channels for a comparator
+  std::vector<UINT> vecCount; //number of comparators on each line
 
-    while(std::getline(infile, strLine)){ //for each line
-      std::istringstream iss(strLine); //prepare for processing
-      vMatching.push_back(vEmptyVec); //new level, empty so far
-      UINT a, b; //pair of channels for a comparator
+  //first pass: find the number of inputs and the depth
 
-      while(iss >> a >> b){ //grab each comparator
-        nInputs = max(max(nInputs, a), b); //adjust inputs seen
-        vMatching[nDepth].push_back(a); //append to current level
-        vMatching[nDepth].push_back(b); //append to current level
-        nSize++; //one more comparator
-      } //while
+  for(const char* p=pBegin; p<pEnd; nDepth++){ //for each line
+    const char* pEol = EndOfLine(p, pEnd); //end of line
+    vecCount.push_back(0);
 
-      nDepth++; //one more level
+    while(ScanUint(p, pEol, a) && ScanUint(p, pEol, b)){ //grab each comparator
+      nInputs = max(max(nInputs, a), b); //adjust inputs seen
+      vecCount.back()++;
     } //while
 
-    nInputs++; //number of inputs is one more than the maximum channel
+    p = (pEol < pEnd)? pEol + 1: pEnd; //next line
+  } //for
+
+  nInputs++; //number of inputs is one more than the maximum channel
+
+  //second pass: insert comparators into the matching array
+
+  if(!CreateMatchArray(nInputs, nDepth))
+    return false; //bail and fail
+
+  for(UINT i=0; i<nDepth; i++) //for each level
+    m_vecLevel[i].reserve(vecCount[i]);
 
-    //process temporary array nMatch into m_nMatch
+  UINT i = 0; //level
 
-    if(bSuccess){
-      CreateMatchArray(nInputs, nDepth);
-      m_nSize = nSize;
+  for(const char* p=pBegin; p<pEnd; i++){ //for each line
+    const char* pEol = EndOfLine(p, pEnd); //end of line
 
-      //convert matching from vMatching to match array m_nMatch
-      
-      for(UINT i=0; i<vMatching.size(); i++)
-        for(UINT j=0; j<vMatching[i].size(); j+=2){
-          const UINT j0 = vMatching[i][j]; //one end of comparator
+    while(ScanUint(p, pEol, a) && ScanUint(p, pEol, b)) //grab each comparator
+      InsertComparator(i, a, b);
+
+    p = (pEol < pEnd)? pEol + 1: pEnd; //next line
+  } //for
+
+  ComputeSize();
+  return true;
+} //ReadText
+
+/// Read a comparator network from a comparator list, which is a sequence of
+/// comparators in the order in which they are to be applied, such as
+/// `[(0,1),(2,3),(0,2),(1,3),(1,2)]`. Anything other than a digit is taken
+/// to be a separator, so brackets, parentheses, braces, commas, colons, and
+/// white space can be used in any combination, including the lists of lists
+/// of Python and JSON and the `[0:1][2:3]` of Knuth. Each consecutive pair of
+/// unsigned integers \f$i, j\f$ is a comparator between channels \f$i\f$ and
+/// \f$j\f$, where channels are numbered from zero. Any grouping of the
+/// comparators into levels in the list is ignored. Instead, they are laid
+/// out into levels by `InsertAsap()`, which gives the least depth possible
+/// without changing the order of the comparators on each channel.
+/// Comparators between a channel and itself are ignored.
+/// \param pBegin Pointer to the first character.
+/// \param pEnd Pointer to one past the last character.
+/// \return true if the input succeeded.
 
-          if(j < vMatching[i].size() - 1){
-            const UINT j1 = vMatching[i][j + 1]; //the other end of comparator
+bool CComparatorNetwork::ReadList(const char* pBegin, const char* pEnd){
+  std::vector<CComparator> vecComp; //comparators in list order
+  UINT nInputs = 0; //number of inputs seen so far
+  UINT a, b; //pair of channels for a comparator
 
-            if(j0 < m_nInputs && j1 < m_nInputs){
-              m_nMatch[i][j0] = j1;
-              m_nMatch[i][j1] = j0;
-            } //if
-          } //if
-        } //for
+  for(const char* p=pBegin; NextUint(p, pEnd, a) && NextUint(p, pEnd, b);)
+    if(a != b){ //skip comparators from a channel to itself
+      vecComp.push_back(CComparator(min(a, b), max(a, b)));
+      nInputs = max(nInputs, max(a, b) + 1);
     } //if
+
+  std::vector<UINT> vecLevel; //level of each comparator
+  InsertAsap(vecComp, nInputs, vecLevel);
+
+  return m_nInputs == nInputs; //false if it ran out of memory
+} //ReadList
+
+/// Create a new comparator network from a sequence of min-max comparators
+/// in the order in which they are to be applied, putting each one at the
+/// earliest level after the last comparator on either of its channels. This
+/// gives the least depth possible without changing the order of the
+/// comparators on each channel, and so without changing what the comparator
+/// network computes. There are no empty levels.
+///
+/// The levels are assigned in one pass through the comparators, keeping
+/// track of the next free level on each channel. The comparators are then
+/// sorted by min channel with a counting sort, so that inserting them in
+/// that order appends them to the comparator lists. This takes time
+/// proportional to the size plus the number of inputs, apart from creating
+/// the matching array.
+/// \param vecComp Comparators in order, with channels less than `nInputs`.
+/// \param nInputs Number of inputs.
+/// \param vecLevel [OUT] Level of each comparator.
+
+void CComparatorNetwork::InsertAsap(const std::vector<CComparator>& vecComp,
+  const UINT nInputs, std::vector<UINT>& vecLevel)
+{
+  const UINT nSize = (UINT)vecComp.size(); //number of comparators
+  std::vector<UINT> vecFree(nInputs, 0); //next free level on each channel
+  UINT nDepth = 0; //depth
+
+  //assign each comparator to the earliest level possible
+
+  vecLevel.resize(nSize);
+
+  for(UINT k=0; k<nSize; k++){ //for each comparator
+    const CComparator& c = vecComp[k]; //the comparator
+    const UINT nLevel = max(vecFree[c.m_nMin], vecFree[c.m_nMax]); //its level
+
+    vecFree[c.m_nMin] = vecFree[c.m_nMax] = nLevel + 1;
+    nDepth = max(nDepth, nLevel + 1);
+    vecLevel[k] = nLevel;
+  } //for
+
+  //counting sort by min channel, reusing vecFree for the start of each
+
+  std::vector<UINT> vecOrder(nSize); //comparators in order of min channel
+  std::fill(vecFree.begin(), vecFree.end(), 0);
+
+  for(const CComparator& c: vecComp) //count comparators with each min channel
+    vecFree[c.m_nMin]++;
+
+  for(UINT i=0, nStart=0; i<nInputs; i++){ //prefix sum
+    const UINT nCount = vecFree[i]; //number with this min channel
+    vecFree[i] = nStart;
+    nStart += nCount;
+  } //for
+
+  for(UINT k=0; k<nSize; k++) //put each comparator in place
+    vecOrder[vecFree[vecComp[k].m_nMin]++] = k;
+
+  //insert comparators, which appends them to the comparator lists
+
+  std::vector<UINT> vecCount(nDepth, 0); //number of comparators on each level
+
+  for(const UINT i: vecLevel) //count them
+    vecCount[i]++;
+
+  if(!CreateMatchArray(nInputs, nDepth))
+    return; //bail, leaving an empty comparator network
+
+  for(UINT i=0; i<nDepth; i++) //for each level
+    m_vecLevel[i].reserve(vecCount[i]);
+
+  for(const UINT k: vecOrder) //for each comparator in order of min channel
+    InsertComparator(vecLevel[k], vecComp[k].m_nMin, vecComp[k].m_nMax);
+
+  ComputeSize();
+} //InsertAsap
+
+/// Test whether file contents are in binary format, that is, whether they
+/// start with the right magic number.
+/// \param p Pointer to the file contents.
+/// \param n Size of the file contents in bytes.
+/// \return true if the contents are in binary format.
+
+bool CComparatorNetwork::IsBinaryImage(const BYTE* p, const size_t n){
+  UINT nMagic = 0; //magic number
+  if(n < sizeof(UINT))return false; //too short
+
+  memcpy(&nMagic, p, sizeof(UINT));
+  return nMagic == g_nMagic;
+} //IsBinaryImage
+
+/// Read a comparator network from the contents of a binary file in the
+/// format written by `GetBinaryImage()`. The comparators are inserted
+/// straight from the file contents into the matching array and the
+/// comparator lists. The contents are rejected if they are truncated, from
+/// a different version, or claim more inputs than the comparators can touch,
+/// in which case the comparator network is left unchanged, or if the
+/// matching array cannot be allocated, any comparator is out of range or
+/// overlaps another, or the comparator network doesn't match the hash and
+/// the first normal form flag in the header, in which case it is left empty.
+/// \param p Pointer to the file contents.
+/// \param n Size of the file contents in bytes.
+/// \return true if the input succeeded.
+
+bool CComparatorNetwork::ReadBinary(const BYTE* p, const size_t n){
+  CBinaryHeader h; //header
+  if(n < sizeof(h))return false; //bail and fail
+  memcpy(&h, p, sizeof(h));
+
+  if(h.m_nMagic != g_nMagic || h.m_nVersion != g_nVersion ||
+    h.m_nWidth != GetIndexBytes(h.m_nInputs) ||
+    (h.m_nFlags & ~FLAG_FIRSTNORMALFORM) != 0 || h.m_nReserved != 0)
+    return false; //bail and fail
+
+  const UINT w = h.m_nWidth; //bytes per channel index
+  const BYTE* pCount = p + sizeof(h); //comparator count for each level
+  const BYTE* pData = pCount + (size_t)h.m_nDepth*sizeof(UINT); //comparators
+
+  if(n < sizeof(h) + (UINT64)h.m_nDepth*sizeof(UINT) + 2ULL*w*h.m_nSize)
+    return false; //truncated
+
+  UINT64 nTotal = 0; //total number of comparators
+
+  for(UINT i=0; i<h.m_nDepth; i++) //for each level
+    nTotal += GetIndex(pCount + i*sizeof(UINT), sizeof(UINT));
+
+  if(nTotal != h.m_nSize)return false; //inconsistent
+
+  if(h.m_nInputs > 2ULL*h.m_nSize + 2)
+    return false; //more inputs than the comparators can touch
+
+  bool ok = CreateMatchArray(h.m_nInputs, h.m_nDepth); //whether all is well so far
+
+  for(UINT i=0; i<h.m_nDepth && ok; i++){ //for each level
+    const UINT nCount = GetIndex(pCount + i*sizeof(UINT), sizeof(UINT));
+    m_vecLevel[i].reserve(nCount);
+
+    for(UINT c=0; c<nCount && ok; c++){ //for each comparator
+      const UINT a = GetIndex(pData, w); //min channel
+      const UINT b = GetIndex(pData + w, w); //max channel
+      pData += 2*w;
+
+      ok = a < b && b < m_nInputs && m_nMatch(i, a) == a && m_nMatch(i, b) == b;
+      if(ok)InsertComparator(i, a, b);
+    } //for
+  } //for
+
+  ComputeSize();
+
+  ok = ok && m_nSize == h.m_nSize && GetHash() == h.m_nHash &&
+    FirstNormalForm() == ((h.m_nFlags & FLAG_FIRSTNORMALFORM) != 0);
+
+  if(!ok){ //leave it empty
+    CreateMatchArray(0, 0);
+    ComputeSize();
   } //if
 
-  return bSuccess;
-} //Read
+  return ok;
+} //ReadBinary
+
+/// Get the contents of a binary file for this comparator network. The
+/// format is a 32-byte header (magic number, version, number of inputs,
+/// depth, size, flags, number of bytes per channel index, two reserved
+/// bytes, and the hash from `GetHash()`), followed by the number of
+/// comparators at each level as 32-bit integers, followed by the min and max
+/// channel of every comparator, level by level and in increasing order of
+/// min channel within each level. Channel indices are 1, 2, or 4 bytes
+/// each, whichever is the narrowest that can hold them. The only flag is
+/// whether it is in first normal form. Integers are little-endian.
+/// \param v [OUT] File contents.
+
+void CComparatorNetwork::GetBinaryImage(std::vector<BYTE>& v) const{
+  CBinaryHeader h; //header
+
+  h.m_nMagic = g_nMagic;
+  h.m_nVersion = g_nVersion;
+  h.m_nInputs = m_nInputs;
+  h.m_nDepth = m_nDepth;
+  h.m_nSize = m_nSize;
+  h.m_nFlags = FirstNormalForm()? FLAG_FIRSTNORMALFORM: 0;
+  h.m_nWidth = (BYTE)GetIndexBytes(m_nInputs);
+  h.m_nHash = GetHash();
+
+  const UINT w = h.m_nWidth; //bytes per channel index
+  v.resize(sizeof(h) + (size_t)m_nDepth*sizeof(UINT) + 2ULL*w*m_nSize);
+  memcpy(v.data(), &h, sizeof(h));
+
+  BYTE* pCount = v.data() + sizeof(h); //comparator count for each level
+  BYTE* pData = pCount + (size_t)m_nDepth*sizeof(UINT); //comparators
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    PutIndex(pCount + i*sizeof(UINT), (UINT)m_vecLevel[i].size(), sizeof(UINT));
+
+    for(const CComparator& c: m_vecLevel[i]){ //for each comparator
+      PutIndex(pData, c.m_nMin, w);
+      PutIndex(pData + w, c.m_nMax, w);
+      pData += 2*w;
+    } //for
+  } //for
+} //GetBinaryImage
 
-/// Insert a comparator between two channels at a certain level.
+/// Write the comparator network to a binary file in the format described
+/// in `GetBinaryImage()`. It can be read back with `Read()`.
+/// \param lpwstr Null terminated wide file name.
+/// \return true if the file was written.
+
+bool CComparatorNetwork::WriteBinary(LPWSTR lpwstr) const{
+  std::vector<BYTE> v; //file contents
+  GetBinaryImage(v);
+
+  FILE* pOutput = nullptr; //output file
+  _wfopen_s(&pOutput, lpwstr, L"wb");
+  if(pOutput == nullptr)return false; //bail and fail
+
+  const bool ok = fwrite(v.data(), 1, v.size(), pOutput) == v.size();
+  return fclose(pOutput) == 0 && ok;
+} //WriteBinary
+
+/// Write the comparator network to a text file in the format read by
+/// `Read()`, that is, one line per level listing the min and max channel of
+/// each comparator at that level in increasing order of min channel. A
+/// comparator network written in binary format and converted to text and
+/// back is unchanged, except that the text format has no way of recording
+/// channels above the largest one that has a comparator on it.
+/// \param lpwstr Null terminated wide file name.
+/// \return true if the file was written.
+
+bool CComparatorNetwork::WriteText(LPWSTR lpwstr) const{
+  std::string str; //file contents
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    for(UINT c=0; c<m_vecLevel[i].size(); c++){ //for each comparator
+      if(c > 0)str.push_back(' ');
+      AppendUint(str, m_vecLevel[i][c].m_nMin);
+      str.push_back(' ');
+      AppendUint(str, m_vecLevel[i][c].m_nMax);
+    } //for
+
+    str.push_back('\n');
+  } //for
+
+  FILE* pOutput = nullptr; //output file
+  _wfopen_s(&pOutput, lpwstr, L"wt");
+  if(pOutput == nullptr)return false; //bail and fail
+
+  const bool ok = fwrite(str.data(), 1, str.size(), pOutput) == str.size();
+  return fclose(pOutput) == 0 && ok;
+} //WriteText
+
+/// Insert a comparator between two channels at a certain level, erasing any
+/// comparators that were already on either channel at that level. The
+/// comparator goes into both the matching array and the comparator list for
+/// that level. This takes constant time if comparators are inserted in
+/// increasing order of min channel, which they usually are. Does not change
+/// the size `m_nSize`.
 /// \param nLevel Level number.
 /// \param i Channel index.
 /// \param j Channel index.
 
 void CComparatorNetwork::InsertComparator(UINT nLevel, UINT i, UINT j){
-  if(nLevel < m_nDepth && i < m_nInputs && j < m_nInputs){
-    m_nMatch[nLevel][i] = j;
-    m_nMatch[nLevel][j] = i;
+  if(nLevel < m_nDepth && i < m_nInputs && j < m_nInputs && i != j){
+    EraseComparator(nLevel, i); //make room
+    EraseComparator(nLevel, j);
+    m_nRevision++;
+
+    m_nMatch.Set(nLevel, i, j);
+    m_nMatch.Set(nLevel, j, i);
+
+    const CComparator c(min(i, j), max(i, j)); //as a min-max comparator
+    std::vector<CComparator>& v = m_vecLevel[nLevel]; //comparators at this level
+
+    if(v.empty() || v.back().m_nMin < c.m_nMin)v.push_back(c); //append
+    else v.insert(std::lower_bound(v.begin(), v.end(), c.m_nMin, LessMin), c);
   } //if
 } //InsertComparator
 
+/// Erase the comparator attached to a channel at a certain level, if there
+/// is one, from both the matching array and the comparator list for that
+/// level. Does not change the size `m_nSize`.
+/// \param nLevel Level number.
+/// \param i Channel index of either end of the comparator.
+/// \return true if a comparator was erased.
+
+bool CComparatorNetwork::EraseComparator(const UINT nLevel, const UINT i){
+  const UINT j = m_nMatch(nLevel, i); //other end of comparator, if any
+  if(j == i || j >= m_nInputs)return false; //no comparator
+
+  m_nMatch.Set(nLevel, i, i);
+  m_nMatch.Set(nLevel, j, j);
+  m_nRevision++;
+
+  std::vector<CComparator>& v = m_vecLevel[nLevel]; //comparators at this level
+  const auto p = std::lower_bound(v.begin(), v.end(), min(i, j), LessMin);
+  if(p != v.end() && p->m_nMin == min(i, j))v.erase(p);
+
+  return true;
+} //EraseComparator
+
+/// Add a comparator between two channels at a certain level, provided neither
+/// channel already has a comparator on it at that level. Whether it sorts
+/// becomes unknown.
+/// \param nLevel Level number.
+/// \param i Channel index.
+/// \param j Channel index.
+/// \return true if the comparator was added.
+
+bool CComparatorNetwork::AddComparator(const UINT nLevel, const UINT i, const UINT j){
+  if(nLevel >= m_nDepth || i >= m_nInputs || j >= m_nInputs || i == j)
+    return false; //bail and fail
+
+  if(m_nMatch(nLevel, i) != i || m_nMatch(nLevel, j) != j)
+    return false; //channel already in use
+
+  InsertComparator(nLevel, i, j);
+  m_nSize++;
+  m_bSorts = false;
+
+  return true;
+} //AddComparator
+
+/// Remove the comparator attached to a channel at a certain level, if there
+/// is one. Whether it sorts becomes unknown.
+/// \param nLevel Level number.
+/// \param i Channel index of either end of the comparator.
+/// \return true if a comparator was removed.
+
+bool CComparatorNetwork::RemoveComparator(const UINT nLevel, const UINT i){
+  if(nLevel >= m_nDepth || i >= m_nInputs)return false; //bail and fail
+  if(!EraseComparator(nLevel, i))return false; //no comparator
+
+  m_nSize--;
+  m_bSorts = false;
+
+  return true;
+} //RemoveComparator
+
 /// Prune down the number of inputs, deleting any comparators attached to the
 /// deleted channels. Does nothing if the desired number of inputs is less 
 /// then 2 or greater than or equal to the current number of inputs.
@@ -134,61 +610,112 @@ void CComparatorNetwork::Prune(const UINT n){
 
   //delete comparators attached to pruned channels
 
-  for(UINT i=0; i<m_nDepth; i++)
-    for(UINT j=0; j<n; j++)
-      if(m_nMatch[i][j] >= n){
-        m_nMatch[i][j] = j;
-      } //if
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    std::vector<CComparator>& v = m_vecLevel[i]; //comparators at this level
+    UINT nKept = 0; //number of comparators kept so far
 
-  m_nInputs = n; //reset the mumber of inputs
+    for(UINT c=0; c<v.size(); c++) //for each comparator
+      if(v[c].m_nMax < n)v[nKept++] = v[c]; //keep it
+      else{ //delete it
+        m_nMatch.Set(i, v[c].m_nMin, v[c].m_nMin);
+        m_nMatch.Set(i, v[c].m_nMax, v[c].m_nMax);
+      } //else
 
-  //recompute the size (number of comparators)
+    v.erase(v.begin() + nKept, v.end());
+  } //for
 
-  m_nSize = 0;
-  
-  for(UINT i=0; i<m_nDepth; i++)
-    for(UINT j=0; j<m_nInputs; j++)
-      if(m_nMatch[i][j] > j)
-        m_nSize++;
+  m_nInputs = n; //reset the mumber of inputs
+  m_nRevision++;
+  ComputeSize(); //recompute the size (number of comparators)
 } //Prune
 
+/// Move each comparator to the earliest level that it can go in without
+/// changing what the comparator network computes, that is, the level after
+/// the last comparator before it on either of its channels, and delete any
+/// empty levels. This may reduce the depth, and never increases it. The
+/// usage flags, if any, go with the comparators. This takes time
+/// proportional to the size plus the number of inputs, apart from creating
+/// the matching array.
+/// \param nOldDepth [OUT] Depth before.
+/// \param nNewDepth [OUT] Depth after.
+
+void CComparatorNetwork::Relayer(UINT& nOldDepth, UINT& nNewDepth){
+  nOldDepth = m_nDepth;
+
+  const bool bUsage = m_bUsed.GetRows() == m_nDepth &&
+    m_bUsed.GetCols() >= m_nInputs; //whether there are usage flags to keep
+
+  std::vector<CComparator> vecComp; //comparators in level order
+  std::vector<bool> vecUsed; //usage flags of min and max channel of each
+  vecComp.reserve(m_nSize);
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(const CComparator& c: m_vecLevel[i]){ //for each comparator
+      vecComp.push_back(c);
+
+      if(bUsage){
+        vecUsed.push_back(m_bUsed(i, c.m_nMin));
+        vecUsed.push_back(m_bUsed(i, c.m_nMax));
+      } //if
+    } //for
+
+  std::vector<UINT> vecLevel; //new level of each comparator
+  InsertAsap(vecComp, m_nInputs, vecLevel);
+
+  if(bUsage){ //put usage flags on the new levels
+    m_bUsed.Create(m_nDepth, m_nInputs, false);
+
+    for(UINT k=0; k<vecComp.size(); k++){ //for each comparator
+      m_bUsed.Set(vecLevel[k], vecComp[k].m_nMin, vecUsed[2*k]);
+      m_bUsed.Set(vecLevel[k], vecComp[k].m_nMax, vecUsed[2*k + 1]);
+    } //for
+  } //if
+
+  nNewDepth = m_nDepth;
+} //Relayer
+
 /// Set the number of inputs and the depth, then create a new matching
-/// array, taking care to delete any old one that may exist.
+/// array and comparator lists with no comparators. The entries of the
+/// matching array are as narrow as the number of inputs allows. Room can be
+/// reserved in each comparator list so that inserting comparators doesn't
+/// reallocate it over and over.
 /// \param nInputs Number of inputs.
 /// \param nDepth Depth.
+/// \param nReserve Number of comparators to reserve room for at each level.
+/// \return true if the matching array was allocated, otherwise there are
+/// no inputs and no levels.
 
-void CComparatorNetwork::CreateMatchArray(UINT nInputs, UINT nDepth){
-  if(m_nMatch){ //there's already one, so delete it
-    for(UINT i=0; i<nDepth; i++)
-      delete [] m_nMatch[i];
-    delete [] m_nMatch;
-  } //if
-
+bool CComparatorNetwork::CreateMatchArray(UINT nInputs, UINT nDepth,
+  const UINT nReserve)
+{
   m_nInputs = nInputs;
   m_nDepth = nDepth;
+  m_nRevision++;
+
+  const bool ok = m_nMatch.Create(m_nDepth, m_nInputs); //success
 
-  m_nMatch = new UINT*[m_nDepth];
+  if(!ok) //bail and fail
+    m_nInputs = m_nDepth = 0;
 
-  for(UINT i=0; i<m_nDepth; i++){
-    m_nMatch[i] = new UINT[m_nInputs];
-    for(UINT j=0; j<m_nInputs; j++)
-      m_nMatch[i][j] = j; //default is unused
+  m_vecLevel.resize(m_nDepth);
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    m_vecLevel[i].clear(); //keeps its memory for reuse
+    m_vecLevel[i].reserve(nReserve);
   } //for
+
+  return ok;
 } //CreateMatchArray
 
 /// Compute the size, that is, number of comparators and stores it in `m_nSize`.
-/// Assumes that the matching array `m_nMatch` has been created and initialized,
-/// otherwise it sets `m_nSize` to zero.
+/// This adds up the lengths of the comparator lists, so it takes time
+/// proportional to the depth.
 
 void CComparatorNetwork::ComputeSize(){
   m_nSize = 0;
 
-  if(m_nMatch)
-    for(UINT i=0; i<m_nDepth; i++){
-      for(UINT j=0; j<m_nInputs; j++)
-        if(m_nMatch[i][j] > j)
-          m_nSize++;
-  } //for
+  for(UINT i=0; i<m_vecLevel.size(); i++) //for each level
+    m_nSize += (UINT)m_vecLevel[i].size();
 } //ComputeSize
 
 /// Reader function for the number of inputs.
@@ -224,16 +751,68 @@ const UINT CComparatorNetwork::GetSize() const{
 /// \return True if in first normal form.
 
 const bool CComparatorNetwork::FirstNormalForm() const{
-  if(m_nMatch == nullptr)return false; //bail and fail
-  if(m_nMatch[0] == nullptr)return false; //bail and fail
+  if(m_nMatch.IsEmpty())return false; //bail and fail
 
   bool ok = true; //true if nothing is inconsistent with first normal form so far
   
   for(UINT j=0; j<m_nInputs-1 && ok; j+=2) //comparators on consecutive channels
-    ok = ok && m_nMatch[0][j] == j + 1 && m_nMatch[0][j + 1] == j;
+    ok = ok && m_nMatch(0, j) == j + 1 && m_nMatch(0, j + 1) == j;
 
   if(ok && odd(m_nInputs)) //last channel is empty
-    ok = ok && m_nMatch[0][m_nInputs - 1] == m_nInputs - 1;
+    ok = ok && m_nMatch(0, m_nInputs - 1) == m_nInputs - 1;
 
   return ok;
 } //FirstNormalForm
+
+
+/// Get the comparators at each level as min-max comparators listed in
+/// increasing order of min channel. Assumes that the array has exactly
+/// `m_nDepth` entries.
+/// \param vecLevel [OUT] Array of `std::vector`s of `CComparator`.
+
+void CComparatorNetwork::GetComparators(std::vector<CComparator>* vecLevel) const{
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    vecLevel[i] = m_vecLevel[i];
+} //GetComparators
+
+/// Get a 64-bit FNV-1a hash of the comparator network. The hash covers the
+/// number of inputs, the depth, and the channels of every comparator at every
+/// level in the order that they are listed by `GetComparators()`, so two
+/// comparator networks with the same comparators at the same levels have the
+/// same hash regardless of how they are stored.
+/// \return Hash of the comparator network.
+
+const UINT64 CComparatorNetwork::GetHash() const{
+  UINT64 h = Fnv1a(&m_nInputs, sizeof(UINT)); //number of inputs
+  h = Fnv1a(&m_nDepth, sizeof(UINT), h); //depth
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    for(const CComparator& c: m_vecLevel[i]){ //for each comparator
+      h = Fnv1a(&c.m_nMin, sizeof(UINT), h); //min channel
+      h = Fnv1a(&c.m_nMax, sizeof(UINT), h); //max channel
+    } //for
+
+    h = Fnv1a(&i, sizeof(UINT), h); //end of level
+  } //for
+
+  return h;
+} //GetHash
+
+/// Reader function for the revision number, which is changed whenever
+/// a comparator is inserted or erased, the comparator network is resized,
+/// or it is pruned. Anything computed from the comparators can be reused
+/// for as long as the revision number stays the same.
+/// \return Revision number.
+
+const UINT64 CComparatorNetwork::GetRevision() const{
+  return m_nRevision;
+} //GetRevision
+
+/// Reader function for the comparators at a level, which are in increasing
+/// order of min channel.
+/// \param i Level, which must be less than the depth.
+/// \return Comparators at level `i`.
+
+const std::vector<CComparator>& CComparatorNetwork::GetLevel(const UINT i) const{
+  return m_vecLevel[i];
+} //GetLevel
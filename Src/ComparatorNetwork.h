@@ -27,41 +27,95 @@
 #define __ComparatorNetwork_h__
 
 #include "Defines.h"
+#include "BitArray.h"
+#include "FlatArray.h"
+#include "MatchArray.h"
+
+/// \brief A min-max or max-min comparator.
+///
+/// This can be either a min-max comparator (when the index of the min channel
+/// is less than the index of the max channel) or a max-min comparator (when 
+/// the index of the min channel is greater than the index of the max channel).
+/// Max-min channels are necessary during the construction of the bitonic
+/// sorting network. The comparators in a `CComparatorNetwork` are always
+/// min-max comparators.
+
+class CComparator{
+  public:
+    UINT m_nMin = 0; ///< Channel index of minimum.
+    UINT m_nMax = 0; ///< Channel index of maximum.
+
+    /// \brief Constructor.
+    ///
+    /// \param nMin Channel index of minimum.
+    /// \param nMax Channel index of maximum.
+
+    CComparator(UINT nMin, UINT nMax): m_nMin(nMin), m_nMax(nMax){}; 
+}; //CComparator
 
 /// \brief Comparator network.
 ///
 /// `CComparatorNetwork` implements a comparator network, which may or may not
 /// sort. Each level of the comparator network is represented by a matching
 /// stored in an array `m_nMatch`. There is a comparator between channels `j`
-/// and `k` at level `i` iff `m_nMatch[i][j] == k && m_nMatch[i][k] == j`.
+/// and `k` at level `i` iff `m_nMatch(i, j) == k && m_nMatch(i, k) == j`.
 /// If there is no comparator on channel `j` at level `i`, then 
-/// `m_nMatch[i][j] == j`.  This will allow for fast verification of whether
-/// a comparator network is a sorting network.
+/// `m_nMatch(i, j) == j`.  This will allow for fast verification of whether
+/// a comparator network is a sorting network. The comparators at each level
+/// are also kept in a list `m_vecLevel[i]` in increasing order of min channel,
+/// so that passes over the whole network take time proportional to its size
+/// instead of its depth times its number of inputs. The two are kept in step
+/// by `InsertComparator()`, `EraseComparator()`, `Read()`, and `Prune()`.
+/// Comparator networks can be read from and written to either a text file
+/// with one line of channel pairs per level, or a binary file with a header
+/// and a packed comparator list per level, which is much faster to load.
+/// They can also be read from a flat list of comparators in the notations
+/// commonly used in the literature, which is laid out into levels as it is
+/// read.
 
 class CComparatorNetwork{
   protected: 
-    UINT** m_nMatch = nullptr; ///< Matchings at each level.
-    bool** m_bUsed = nullptr; ///< Whether comparators are used when sorting.
+    CMatchArray m_nMatch; ///< Matchings at each level.
+    std::vector<std::vector<CComparator>> m_vecLevel; ///< Comparators at each level.
+    CBitArray m_bUsed; ///< Whether comparators are used when sorting.
 
     UINT m_nInputs = 0; ///< Number of inputs.
     UINT m_nDepth = 0; ///< Depth.
     UINT m_nSize = 0; ///< Size.
+    UINT64 m_nRevision = 0; ///< Incremented whenever the comparators change.
 
     bool m_bSorts = false; ///< True if it sorts, false if it doesn't or unknown.
 
     void InsertComparator(UINT, UINT, UINT); ///< Insert comparator.
-    void CreateMatchArray(UINT, UINT); ///< Create match array.
+    bool EraseComparator(const UINT, const UINT); ///< Erase comparator.
+    bool CreateMatchArray(UINT, UINT, const UINT=0); ///< Create match array.
     void ComputeSize(); ///< Compute size.
+    void GetComparators(std::vector<CComparator>*) const; ///< Get comparators.
+    void InsertAsap(const std::vector<CComparator>&, const UINT, std::vector<UINT>&); ///< Insert comparators at earliest levels.
 
-  public: 
-    ~CComparatorNetwork(); ///< Destructor.
+    bool ReadText(const char*, const char*); ///< Read from text.
+    bool ReadList(const char*, const char*); ///< Read from comparator list.
+    bool ReadBinary(const BYTE*, const size_t); ///< Read from binary.
 
+  public: 
     virtual bool Read(LPWSTR); ///< Read from file.
+    virtual bool ReadImage(const BYTE*, const size_t); ///< Read from file contents.
+    bool WriteText(LPWSTR) const; ///< Write to text file.
+    bool WriteBinary(LPWSTR) const; ///< Write to binary file.
+    void GetBinaryImage(std::vector<BYTE>&) const; ///< Get binary file contents.
+    static bool IsBinaryImage(const BYTE*, const size_t); ///< Test for binary file contents.
+
     void Prune(const UINT); ///< Prune down number of inputs.
+    virtual void Relayer(UINT&, UINT&); ///< Move comparators to earliest levels.
+    bool AddComparator(const UINT, const UINT, const UINT); ///< Add a comparator.
+    bool RemoveComparator(const UINT, const UINT); ///< Remove a comparator.
 
     const UINT GetNumInputs() const; ///< Get number of inputs.
     const UINT GetDepth() const; ///< Get depth.
     const UINT GetSize() const; ///< Get size.
+    const UINT64 GetHash() const; ///< Get hash.
+    const UINT64 GetRevision() const; ///< Get revision number.
+    const std::vector<CComparator>& GetLevel(const UINT) const; ///< Get comparators at a level.
 
     const bool FirstNormalForm() const; ///< Test for first normal form.
 }; //CComparatorNetwork
@@ -43,4 +43,43 @@ enum class eExport{
   Png, Svg, TeX
 }; //eExport
 
+/// \brief Verification engine.
+///
+/// The algorithm used to test whether a comparator network sorts, either
+/// `GrayCode`, which pushes one zero-one input at a time through the
+/// comparator network in Gray code order, `BitSliced`, which pushes 64
+/// zero-one inputs at a time through the comparator network using bitwise
+/// operations on 64-bit words, `Parallel`, which splits the Gray code
+/// into ranges and verifies them on multiple threads, `ReachableSet`,
+/// which computes the set of distinct zero-one vectors after each level,
+/// `DenseBitmap`, which does the same using a bitmap of all vectors,
+/// `Prefix`, which computes the set of distinct zero-one vectors after the
+/// first few levels and pushes only those through the rest, or
+/// `Incremental`, which keeps the set after each level between calls and
+/// only recomputes the ones after a level that has changed.
+
+enum class eVerify{
+  GrayCode, BitSliced, Parallel, ReachableSet, DenseBitmap, Prefix, Incremental
+}; //eVerify
+
+/// \brief Lane kernel.
+///
+/// The instruction set used by the bit-sliced verification engine, either 
+/// `Scalar` for plain 64-bit integer operations on 64 inputs at a time, 
+/// `Avx2` for 256-bit registers on 256 inputs at a time, or `Avx512` for
+/// 512-bit registers on 512 inputs at a time.
+
+enum class eKernel{
+  Scalar, Avx2, Avx512
+}; //eKernel
+
+/// \brief Index width.
+///
+/// The number of bits used to store each channel index in a matching
+/// array, either `Bits8`, `Bits16`, or `Bits32`.
+
+enum class eIndexWidth{
+  Bits8, Bits16, Bits32
+}; //eIndexWidth
+
 #endif //__Defines_h__
@@ -0,0 +1,406 @@
+/// \file DenseBitmapVerifier.cpp
+/// \brief Code for the dense bitmap verifier CDenseBitmapVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "DenseBitmapVerifier.h"
+#include "LaneKernels.h"
+
+/// Insert a zero bit into a number.
+/// \param t A number.
+/// \param b Position of the new bit.
+/// \return t with the bits at position b and above moved up by one.
+
+static inline UINT64 InsertZero(const UINT64 t, const UINT b){
+  const UINT64 nLow = t & ((1ULL << b) - 1); //bits below b
+  return ((t ^ nLow) << 1) | nLow;
+} //InsertZero
+
+/// Spread the low bits of a number out into the positions of the one bits
+/// of a mask, the least significant bit going to the lowest one bit.
+/// \param t A number.
+/// \param m Mask.
+/// \return The bits of t in the positions of the one bits of m.
+
+static inline UINT64 Deposit(UINT64 t, UINT64 m){
+  UINT64 r = 0; //result
+
+  for(; m; m&=m - 1, t>>=1) //for each one bit of the mask
+    if(t & 1)r |= m & ~(m - 1); //lowest one bit
+
+  return r;
+} //Deposit
+
+/// Count the one bits in a number.
+/// \param t A number.
+/// \return Number of one bits in t.
+
+static inline UINT CountBits(UINT64 t){
+  UINT n = 0; //the count
+
+  for(; t; t&=t - 1) //for each one bit
+    ++n;
+
+  return n;
+} //CountBits
+
+static const UINT TILEBITS = 16; ///< Base 2 logarithm of most words in a tile.
+static const UINT RUNBITS = 10; ///< Base 2 logarithm of fewest contiguous words in a tile.
+
+/// Copy the comparators at each level, mark them as not having swapped,
+/// group them into passes, and try to allocate the bitmap. If there are too
+/// many inputs or not enough memory then the bitmap is not allocated, which
+/// can be checked with `IsReady()`.
+/// \param nInputs Number of inputs.
+/// \param vecLevel Array of `std::vector`s of min-max `CComparator`s.
+/// \param nDepth Number of entries in `vecLevel`.
+/// \param nThreads Number of threads, or zero for one per hardware thread.
+
+CDenseBitmapVerifier::CDenseBitmapVerifier(const UINT nInputs,
+  std::vector<CComparator>* vecLevel, const UINT nDepth, const UINT nThreads):
+  m_nInputs(nInputs), m_nDepth(nDepth)
+{
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    m_vecLevel.push_back(vecLevel[i]);
+    m_vecSwapped.push_back(std::vector<bool>(vecLevel[i].size(), false));
+  } //for
+
+  m_nThreads = nThreads? nThreads: std::thread::hardware_concurrency();
+  m_nThreads = max(1U, m_nThreads); //safety
+
+  const UINT64 nBytes = GetBytes(m_nInputs); //memory needed
+
+  if(nBytes > 0){ //not too many inputs
+    m_nWords = nBytes/sizeof(UINT64);
+    m_nBitmap = new (std::nothrow) UINT64[m_nWords];
+    Plan();
+  } //if
+} //constructor
+
+/// Delete the bitmap.
+
+CDenseBitmapVerifier::~CDenseBitmapVerifier(){
+  delete [] m_nBitmap;
+} //destructor
+
+/// Get the amount of memory needed for the bitmap, which is \f$2^n\f$ bits 
+/// rounded up to a whole 64-bit word.
+/// \param nInputs Number of inputs.
+/// \return Number of bytes, or zero if there are more than 32 inputs.
+
+const UINT64 CDenseBitmapVerifier::GetBytes(const UINT nInputs){
+  if(nInputs > 32)return 0; //too many
+  return sizeof(UINT64)*max(1ULL, 1ULL << nInputs >> 6);
+} //GetBytes
+
+/// Whether the bitmap was allocated successfully.
+/// \return true if `Verify()` can be called.
+
+bool CDenseBitmapVerifier::IsReady() const{
+  return m_nBitmap != nullptr;
+} //IsReady
+
+/// Group the comparators on each level into passes. A comparator between
+/// channels \f$j < k\f$ needs bit \f$k - 6\f$ of the word index to vary
+/// within a tile if \f$k \geq 6\f$, and likewise for \f$j\f$. The lowest
+/// `RUNBITS` bits always vary, so that a tile is made up of runs of contiguous
+/// words that are long enough to copy quickly. Comparators are added to the
+/// current pass in order until one would need more than `m_nTileBits` bits,
+/// which can only happen with more than 22 inputs. Each pass's mask is then
+/// topped up with the lowest unused bits, and its comparators' channels are
+/// renumbered by where their bits fall among the mask bits, so that they can
+/// be applied to a tile as if it were a bitmap of its own.
+
+void CDenseBitmapVerifier::Plan(){
+  const UINT64 nAll = m_nWords - 1; //all word index bits
+  m_nTileBits = min(TILEBITS, CountBits(nAll));
+
+  const UINT64 nRun = ((1ULL << min(RUNBITS, m_nTileBits)) - 1) & nAll; //low bits
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    UINT c = 0; //index of next comparator in level
+
+    while(c < m_vecLevel[i].size()){ //for each pass on this level
+      UINT64 M = nRun; //word index bits needed by this pass
+      std::vector<UINT> vIndex; //comparators in this pass
+
+      for(; c<m_vecLevel[i].size(); c++){ //for each comparator that fits
+        const CComparator& p = m_vecLevel[i][c];
+        UINT64 b = M; //bits needed with this comparator
+        if(p.m_nMin >= 6)b |= 1ULL << (p.m_nMin - 6);
+        if(p.m_nMax >= 6)b |= 1ULL << (p.m_nMax - 6);
+
+        if(CountBits(b) > m_nTileBits)break; //pass is full
+        M = b;
+        vIndex.push_back(c);
+      } //for
+
+      for(UINT64 b=1; CountBits(M) < m_nTileBits; b<<=1) //top up with low bits
+        M |= b & nAll;
+
+      std::vector<CComparator> vecPass; //renumbered comparators
+
+      for(UINT u: vIndex){ //for each comparator in this pass
+        const CComparator& p = m_vecLevel[i][u];
+        UINT j = p.m_nMin, k = p.m_nMax; //channels
+        if(j >= 6)j = 6 + CountBits(M & ((1ULL << (j - 6)) - 1));
+        if(k >= 6)k = 6 + CountBits(M & ((1ULL << (k - 6)) - 1));
+        vecPass.push_back(CComparator(j, k));
+      } //for
+
+      m_vPassLevel.push_back(i);
+      m_vPassMask.push_back(M);
+      m_vecPassIndex.push_back(vIndex);
+      m_vecPassComparator.push_back(vecPass);
+    } //while
+  } //for
+} //Plan
+
+/// Apply a comparator between channels \f$j < k\f$ to part of the bitmap.
+/// Each pass works on a set of independent units, which are single words if
+/// \f$k < 6\f$, pairs of words whose indices differ in bit \f$k - 6\f$ if 
+/// \f$j < 6 \leq k\f$, and pairs of words whose indices differ in bits
+/// \f$j - 6\f$ and \f$k - 6\f$ otherwise. Units are processed in order of
+/// word index, which is contiguous within runs.
+/// \param p Pointer to the bitmap, or to a tile of it.
+/// \param c Comparator.
+/// \param nFirst Index of first unit.
+/// \param nLast One past the index of the last unit.
+/// \return Nonzero iff the comparator swaps on any vector in these units.
+
+UINT64 CDenseBitmapVerifier::Pass(UINT64* p, const CComparator& c,
+  const UINT64 nFirst, const UINT64 nLast)
+{
+  const UINT j = c.m_nMin; //min channel
+  const UINT k = c.m_nMax; //max channel
+  UINT64 nMoved = 0; //vectors moved
+
+  if(k < 6){ //within each word
+    const UINT64 m = g_nLane[j] & ~g_nLane[k]; //one on channel j, zero on k
+    const UINT s = (1U << k) - (1U << j); //distance moved
+
+    for(UINT64 w=nFirst; w<nLast; w++){ //for each word
+      const UINT64 x = p[w] & m; //vectors to move
+      nMoved |= x;
+      p[w] = (p[w] ^ x) | (x << s);
+    } //for
+  } //if
+
+  else if(j < 6){ //within each word to another word
+    const UINT64 K = 1ULL << (k - 6); //word index difference for channel k
+    const UINT64 m = g_nLane[j]; //one on channel j
+    const UINT s = 1U << j; //distance moved within word
+
+    for(UINT64 t=nFirst; t<nLast;){ //for each run of units
+      UINT64* q = p + InsertZero(t, k - 6); //first word in run
+      const UINT64 n = min(K - (t & (K - 1)), nLast - t); //run length
+
+      for(UINT64 r=0; r<n; r++){ //for each unit in run
+        const UINT64 x = q[r] & m; //vectors to move
+        nMoved |= x;
+        q[r] ^= x;
+        q[r + K] |= x >> s;
+      } //for
+
+      t += n;
+    } //for
+  } //else if
+
+  else{ //whole words to other words
+    const UINT64 J = 1ULL << (j - 6); //word index difference for channel j
+    const UINT64 K = 1ULL << (k - 6); //word index difference for channel k
+
+    for(UINT64 t=nFirst; t<nLast;){ //for each run of units
+      UINT64* q = p + InsertZero(InsertZero(t, j - 6), k - 6); //first word in run
+      const UINT64 n = min(J - (t & (J - 1)), nLast - t); //run length
+
+      for(UINT64 r=0; r<n; r++){ //for each unit in run
+        const UINT64 x = q[r + J]; //vectors to move
+        nMoved |= x;
+        q[r + K] |= x;
+        q[r + J] = 0;
+      } //for
+
+      t += n;
+    } //for
+  } //else
+
+  return nMoved;
+} //Pass
+
+/// Apply a pass to one tile of the bitmap. The words of the tile are those
+/// whose indices agree with the tile's base outside of the pass's mask. If
+/// the mask is the low bits of the word index then they are contiguous and
+/// are worked on in place, otherwise they are gathered into a buffer in
+/// order of word index and scattered back afterwards, one run of contiguous
+/// words at a time. Each comparator in the pass is applied to the whole tile
+/// in turn.
+/// \param nPass Pass.
+/// \param nTile Tile index.
+/// \param nBuffer [IN, OUT] Buffer with room for a tile.
+/// \param vecSwapped [IN, OUT] Whether each comparator swaps, indexed by
+/// level then comparator.
+
+void CDenseBitmapVerifier::ApplyTile(const UINT nPass, const UINT64 nTile,
+  UINT64* nBuffer, std::vector<std::vector<bool>>& vecSwapped)
+{
+  const UINT64 M = m_vPassMask[nPass]; //bits that vary within the tile
+  const UINT64 nBase = Deposit(nTile, (m_nWords - 1) & ~M); //first word
+  const UINT64 nWords = 1ULL << m_nTileBits; //words in tile
+  const bool bInPlace = (M & (M + 1)) == 0; //low bits only
+  UINT64* q = bInPlace? m_nBitmap + nBase: nBuffer; //words of the tile
+
+  const UINT64 nRun = ~M & (M + 1); //words in a run, from the trailing ones of the mask
+  const UINT64 R = M ^ (nRun - 1); //bits that vary between runs
+  const size_t nRunBytes = nRun*sizeof(UINT64); //bytes in a run
+
+  if(!bInPlace){ //gather
+    UINT64 s = 0; //subset of mask bits
+
+    for(UINT64 w=0; w<nWords; w+=nRun){ //each run in order
+      memcpy(q + w, m_nBitmap + (nBase | s), nRunBytes);
+      s = (s - R) & R;
+    } //for
+  } //if
+
+  const std::vector<CComparator>& vecPass = m_vecPassComparator[nPass]; //comparators
+  const std::vector<UINT>& vIndex = m_vecPassIndex[nPass]; //their indices in the level
+  std::vector<bool>& vSwapped = vecSwapped[m_vPassLevel[nPass]]; //whether they swap
+
+  for(UINT c=0; c<vecPass.size(); c++){ //for each comparator
+    UINT64 nUnits = nWords; //number of units
+    if(vecPass[c].m_nMax >= 6)nUnits /= 2; //pairs of words
+    if(vecPass[c].m_nMin >= 6)nUnits /= 2; //pairs of pairs of words
+
+    if(Pass(q, vecPass[c], 0, nUnits) != 0)
+      vSwapped[vIndex[c]] = true;
+  } //for
+
+  if(!bInPlace){ //scatter
+    UINT64 s = 0; //subset of mask bits
+
+    for(UINT64 w=0; w<nWords; w+=nRun){ //each run in order
+      memcpy(m_nBitmap + (nBase | s), q + w, nRunBytes);
+      s = (s - R) & R;
+    } //for
+  } //if
+} //ApplyTile
+
+/// Check whether the comparator network sorts all zero-one inputs by starting
+/// with all vectors in the bitmap and applying each pass in turn.
+/// Every sorted vector is mapped to itself, so it sorts iff exactly
+/// \f$n + 1\f$ vectors are left at the end. The tiles of each pass are handed
+/// out to threads one at a time, and the threads wait for each other at the
+/// end of each pass, since the next one may need any word of the bitmap.
+/// Assumes that `IsReady()` is true.
+/// \return true if it sorts.
+
+bool CDenseBitmapVerifier::Verify(){
+  const UINT64 nFirst = m_nInputs < 6? (1ULL << (1U << m_nInputs)) - 1: ~0ULL;
+
+  for(UINT64 w=0; w<m_nWords; w++) //every vector
+    m_nBitmap[w] = nFirst;
+
+  const UINT nPasses = (UINT)m_vPassMask.size(); //number of passes
+  const UINT64 nTiles = m_nWords >> m_nTileBits; //number of tiles per pass
+  const UINT nThreads = (UINT)min((UINT64)m_nThreads, nTiles); //no idle threads
+
+  std::vector<std::atomic<UINT64>> nNext(nPasses); //next tile in each pass
+  for(std::atomic<UINT64>& n: nNext)n = 0;
+
+  std::mutex mutex; //for the barrier
+  std::condition_variable cv; //for the barrier
+  UINT nArrived = 0; //number of threads at the barrier
+  UINT64 nGeneration = 0; //number of times the barrier has opened
+
+  auto Arrive = [&](){ //wait for all threads to finish the pass
+    std::unique_lock<std::mutex> lock(mutex);
+    const UINT64 g = nGeneration; //current generation
+
+    if(++nArrived == nThreads){ //last one in opens the barrier
+      nArrived = 0;
+      ++nGeneration;
+      cv.notify_all();
+    } //if
+
+    else cv.wait(lock, [&](){return nGeneration != g;});
+  }; //Arrive
+
+  std::vector<std::vector<std::vector<bool>>> vecSwapped(nThreads, m_vecSwapped); //per thread
+
+  auto Work = [&](const UINT t){ //thread function
+    std::vector<UINT64> nBuffer(1ULL << m_nTileBits); //room for a tile
+
+    for(UINT p=0; p<nPasses; p++){ //for each pass
+      for(UINT64 u=nNext[p]++; u<nTiles; u=nNext[p]++) //for each tile
+        ApplyTile(p, u, nBuffer.data(), vecSwapped[t]);
+
+      if(nThreads > 1)Arrive();
+    } //for
+  }; //Work
+
+  std::vector<std::thread> vecThread; //worker threads
+
+  for(UINT t=1; t<nThreads; t++)
+    vecThread.push_back(std::thread(Work, t));
+
+  Work(0);
+
+  for(std::thread& t: vecThread)
+    t.join();
+
+  for(UINT t=0; t<nThreads; t++) //merge usage
+    for(UINT i=0; i<m_nDepth; i++) //for each level
+      for(UINT c=0; c<m_vecLevel[i].size(); c++) //for each comparator
+        if(vecSwapped[t][i][c])
+          m_vecSwapped[i][c] = true;
+
+  UINT64 nCount = 0; //number of vectors left
+
+  for(UINT64 w=0; w<m_nWords; w++) //for each word
+    for(UINT64 x=m_nBitmap[w]; x; x&=x - 1) //for each one bit
+      ++nCount;
+
+  return nCount == m_nInputs + 1;
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs during `Verify()` as used. Other entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CDenseBitmapVerifier::GetUsage(CBitArray& bUsed) const{
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(UINT c=0; c<m_vecLevel[i].size(); c++) //for each comparator
+      if(m_vecSwapped[i][c]){
+        const CComparator& p = m_vecLevel[i][c];
+        bUsed.Set(i, p.m_nMin); //mark both channels used
+        bUsed.Set(i, p.m_nMax);
+      } //if
+} //GetUsage
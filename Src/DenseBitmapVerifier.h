@@ -0,0 +1,89 @@
+/// \file DenseBitmapVerifier.h
+/// \brief Interface for the dense bitmap verifier CDenseBitmapVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __DenseBitmapVerifier_h__
+#define __DenseBitmapVerifier_h__
+
+#include "Platform.h"
+#include "ComparatorNetwork.h"
+
+/// \brief Dense bitmap verifier.
+///
+/// `CDenseBitmapVerifier` computes the set of zero-one vectors that can appear
+/// on the channels after each level, like `CReachableSetVerifier`, but it
+/// stores the set as a bitmap with one bit for each of the \f$2^n\f$ vectors,
+/// bit \f$x\f$ being set iff the vector whose value on channel \f$j\f$ is bit
+/// \f$j\f$ of \f$x\f$ is in the set. A comparator between channels \f$j < k\f$
+/// moves every vector with a one on channel \f$j\f$ and a zero on channel \f$k\f$
+/// to the vector with those two bits exchanged, which is a single streaming
+/// pass over the bitmap with no data-dependent branches. If \f$j\f$ and \f$k\f$
+/// are both less than 6 then the pass is a mask and shift within each 64-bit
+/// word. Otherwise it moves whole words, or parts of words, from one half or
+/// quarter of the bitmap to another. The comparators on a level are disjoint,
+/// so they can be applied in any order, and they are grouped into as few
+/// passes over the bitmap as possible. The bitmap is cut into tiles of
+/// \f$2^{16}\f$ words whose indices vary only in the low bits and the bits
+/// that the comparators in a pass need, and each tile is copied into a buffer
+/// (unless its words are already contiguous), has every comparator in the pass
+/// applied to it while it is in cache, and is copied back. The tiles of each pass are shared
+/// out between threads that are started once and wait for each other at the
+/// end of each pass. The bitmap takes \f$2^{n - 3}\f$ bytes, for example 128MB for \f$n = 30\f$,
+/// so this is limited to at most 32 inputs.
+
+class CDenseBitmapVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    std::vector<std::vector<CComparator>> m_vecLevel; ///< Comparators at each level.
+    std::vector<std::vector<bool>> m_vecSwapped; ///< Whether each comparator swaps.
+
+    UINT64* m_nBitmap = nullptr; ///< The bitmap.
+    UINT64 m_nWords = 0; ///< Number of 64-bit words in the bitmap.
+    UINT m_nThreads = 1; ///< Number of threads.
+
+    UINT m_nTileBits = 0; ///< Base 2 logarithm of number of words in a tile.
+    std::vector<UINT> m_vPassLevel; ///< Level of each pass.
+    std::vector<UINT64> m_vPassMask; ///< Word index bits that vary within a tile in each pass.
+    std::vector<std::vector<UINT>> m_vecPassIndex; ///< Index in its level of each comparator in each pass.
+    std::vector<std::vector<CComparator>> m_vecPassComparator; ///< Comparators in each pass, renumbered within a tile.
+
+    void Plan(); ///< Group the comparators into passes.
+    static UINT64 Pass(UINT64*, const CComparator&, const UINT64, const UINT64); ///< Apply part of a comparator.
+    void ApplyTile(const UINT, const UINT64, UINT64*,
+      std::vector<std::vector<bool>>&); ///< Apply a pass to a tile.
+
+  public:
+    CDenseBitmapVerifier(const UINT, std::vector<CComparator>*, const UINT,
+      const UINT=0); ///< Constructor.
+    ~CDenseBitmapVerifier(); ///< Destructor.
+
+    static const UINT64 GetBytes(const UINT); ///< Memory needed.
+    bool IsReady() const; ///< Whether the bitmap was allocated.
+
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+}; //CDenseBitmapVerifier
+
+#endif //__DenseBitmapVerifier_h__
@@ -0,0 +1,234 @@
+/// \file FlatArray.h
+/// \brief Interface and code for the two-dimensional array CFlatArray.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __FlatArray_h__
+#define __FlatArray_h__
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Platform.h"
+
+/// \brief Flat two-dimensional array.
+///
+/// `CFlatArray` is a two-dimensional array stored in a single contiguous block
+/// of memory in row-major order, that is, row \f$i\f$ occupies entries
+/// \f$im\f$ through \f$im + m - 1\f$, where \f$m\f$ is the number of columns.
+/// The block is aligned to a cache line. Compared to an array of pointers to
+/// separately allocated rows, this needs one allocation instead of one per
+/// row plus one, it keeps the rows next to each other in memory, and it
+/// can be copied and moved safely. Entry \f$(i, j)\f$ can be accessed either
+/// as `a[i][j]`, which checks \f$i\f$, or as `a(i, j)`, which checks both
+/// \f$i\f$ and \f$j\f$. The checks are assertions, so they cost nothing
+/// in a release build. The memory is only reallocated by `Create()` if
+/// the block isn't big enough already. If it can't be allocated, the array
+/// is left empty.
+/// \tparam T Entry type, which must be trivially copyable.
+
+template<class T> class CFlatArray{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "CFlatArray entries must be trivially copyable");
+
+  private:
+    static const size_t ALIGNMENT = 64; ///< Alignment in bytes, a cache line.
+
+    BYTE* m_pBlock = nullptr; ///< Memory block, with slack for alignment.
+    T* m_pData = nullptr; ///< First entry, aligned.
+    size_t m_nCapacity = 0; ///< Number of entries that fit in the block.
+    UINT m_nRows = 0; ///< Number of rows.
+    UINT m_nCols = 0; ///< Number of columns.
+
+    /// Make sure that the block has room for a given number of entries,
+    /// reallocating it if necessary. The old entries are not kept. If the
+    /// block can't be allocated, the array is left empty.
+    /// \param n Number of entries.
+    /// \return true if there is room.
+
+    bool Reserve(const size_t n){
+      if(n <= m_nCapacity)return true; //big enough already
+
+      delete [] m_pBlock;
+      m_pBlock = new (std::nothrow) BYTE[n*sizeof(T) + ALIGNMENT - 1];
+
+      if(m_pBlock == nullptr){ //bail and fail
+        m_pData = nullptr;
+        m_nCapacity = 0;
+        m_nRows = m_nCols = 0;
+        return false;
+      } //if
+
+      const uintptr_t p = (uintptr_t)m_pBlock; //address of block
+      m_pData = (T*)((p + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+      m_nCapacity = n;
+
+      return true;
+    } //Reserve
+
+  public:
+    CFlatArray() = default; ///< Default constructor.
+
+    /// Copy constructor.
+    /// \param a Array to copy.
+
+    CFlatArray(const CFlatArray& a){
+      *this = a;
+    } //copy constructor
+
+    /// Move constructor.
+    /// \param a Array to move, which is left empty.
+
+    CFlatArray(CFlatArray&& a) noexcept{
+      *this = std::move(a);
+    } //move constructor
+
+    /// Delete the memory block.
+
+    ~CFlatArray(){
+      delete [] m_pBlock;
+    } //destructor
+
+    /// Copy assignment, which reuses the memory block if it's big enough.
+    /// If memory runs out, this array is left empty.
+    /// \param a Array to copy.
+    /// \return This array.
+
+    CFlatArray& operator=(const CFlatArray& a){
+      if(this != &a){
+        if(!Reserve(a.GetCount()))return *this; //bail and fail
+        m_nRows = a.m_nRows;
+        m_nCols = a.m_nCols;
+        if(a.GetCount() > 0)memcpy(m_pData, a.m_pData, a.GetCount()*sizeof(T));
+      } //if
+
+      return *this;
+    } //operator=
+
+    /// Move assignment, which takes the memory block from the other array.
+    /// \param a Array to move, which is left empty.
+    /// \return This array.
+
+    CFlatArray& operator=(CFlatArray&& a) noexcept{
+      if(this != &a){
+        std::swap(m_pBlock, a.m_pBlock);
+        std::swap(m_pData, a.m_pData);
+        std::swap(m_nCapacity, a.m_nCapacity);
+        m_nRows = a.m_nRows;
+        m_nCols = a.m_nCols;
+        a.m_nRows = a.m_nCols = 0;
+      } //if
+
+      return *this;
+    } //operator=
+
+    /// Set the number of rows and columns and set every entry to the same
+    /// value. The old entries are not kept. If memory runs out, the array
+    /// is left empty.
+    /// \param nRows Number of rows.
+    /// \param nCols Number of columns.
+    /// \param x Initial value of every entry.
+    /// \return true if the memory was allocated.
+
+    bool Create(const UINT nRows, const UINT nCols, const T& x){
+      if(!Reserve((size_t)nRows*nCols))return false; //bail and fail
+      m_nRows = nRows;
+      m_nCols = nCols;
+
+      for(size_t i=0; i<GetCount(); i++)
+        m_pData[i] = x;
+
+      return true;
+    } //Create
+
+    /// Get a row.
+    /// \param i Row index.
+    /// \return Pointer to the first entry in row \f$i\f$.
+
+    T* operator[](const UINT i){
+      assert(i < m_nRows);
+      return m_pData + (size_t)i*m_nCols;
+    } //operator[]
+
+    /// Get a row.
+    /// \param i Row index.
+    /// \return Pointer to the first entry in row \f$i\f$.
+
+    const T* operator[](const UINT i) const{
+      assert(i < m_nRows);
+      return m_pData + (size_t)i*m_nCols;
+    } //operator[]
+
+    /// Get an entry.
+    /// \param i Row index.
+    /// \param j Column index.
+    /// \return Reference to the entry in row \f$i\f$ and column \f$j\f$.
+
+    T& operator()(const UINT i, const UINT j){
+      assert(i < m_nRows && j < m_nCols);
+      return m_pData[(size_t)i*m_nCols + j];
+    } //operator()
+
+    /// Get an entry.
+    /// \param i Row index.
+    /// \param j Column index.
+    /// \return Reference to the entry in row \f$i\f$ and column \f$j\f$.
+
+    const T& operator()(const UINT i, const UINT j) const{
+      assert(i < m_nRows && j < m_nCols);
+      return m_pData[(size_t)i*m_nCols + j];
+    } //operator()
+
+    /// Get the number of rows.
+    /// \return Number of rows.
+
+    const UINT GetRows() const{
+      return m_nRows;
+    } //GetRows
+
+    /// Get the number of columns.
+    /// \return Number of columns.
+
+    const UINT GetCols() const{
+      return m_nCols;
+    } //GetCols
+
+    /// Get the number of entries.
+    /// \return Number of rows times number of columns.
+
+    const size_t GetCount() const{
+      return (size_t)m_nRows*m_nCols;
+    } //GetCount
+
+    /// Whether there are no entries.
+    /// \return true if there are no entries.
+
+    const bool IsEmpty() const{
+      return GetCount() == 0;
+    } //IsEmpty
+}; //CFlatArray
+
+#endif //__FlatArray_h__
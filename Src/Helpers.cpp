@@ -44,16 +44,89 @@ bool IsPowerOf2(const UINT n){
 /// Compute the ceiling of log base 2. For speed, this relies on the Windows
 /// API function `_BitScanReverse`, which uses the corresponding native
 /// machine-code instruction to find the index of the most significant 1 in the
-/// binary representation of an unsigned integer. In retrospect this is
-/// probably overkill for this application but you have to admit that it's cool.
+/// binary representation of an unsigned integer. Other compilers get the same
+/// instruction from `__builtin_clz`, which counts the leading zeros instead.
+/// In retrospect this is probably overkill for this application but you have
+/// to admit that it's cool.
 /// \param n A number.
 /// \return Log base 2 of the smallest power of 2 greater than or equal to n.
 
 UINT CeilLog2(const UINT n){ ///< Ceiling of log base 2.
   if(n == 0)return 0; //safety
 
+#if defined(_MSC_VER)
   DWORD k = 0; //for index of most significant 1
   _BitScanReverse(&k, n); //find index of most significant 1
+#else
+  const UINT k = 31 - __builtin_clz(n); //index of most significant 1
+#endif
 
   return IsPowerOf2(n)? k: k + 1;
 } //NextPowerOf2
+
+/// Compute the 64-bit FNV-1a hash of a block of bytes. This is not a
+/// cryptographic hash, but it is fast and good enough to tell whether two
+/// comparator networks or two files are different. Hashes can be chained by
+/// passing the hash of one block as the seed for the next.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \param h Seed, which defaults to the FNV-1a offset basis.
+/// \return The hash.
+
+UINT64 Fnv1a(const void* p, const size_t n, UINT64 h){
+  const unsigned char* q = (const unsigned char*)p; //bytes
+
+  for(size_t i=0; i<n; i++){ //for each byte
+    h ^= q[i];
+    h *= 1099511628211ULL; //FNV prime
+  } //for
+
+  return h;
+} //Fnv1a
+
+/// Scan an unsigned decimal integer from text, skipping any blanks (spaces,
+/// tabs, carriage returns, vertical tabs, and form feeds) in front of it,
+/// but not newlines. This is a hand-written replacement for
+/// `std::istream::operator>>` that works directly on a range of characters,
+/// for example one in a memory-mapped file. It fails if the next thing
+/// after the blanks is not a digit or if the integer doesn't fit.
+/// \param p [IN, OUT] Pointer to the next character, moved past the integer.
+/// \param pEnd Pointer to one past the last character.
+/// \param n [OUT] The integer.
+/// \return true if an integer was scanned.
+
+bool ScanUint(const char*& p, const char* pEnd, UINT& n){
+  while(p < pEnd && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\v' ||
+    *p == '\f'))
+    p++; //skip blanks
+
+  if(p == pEnd || *p < '0' || *p > '9')return false; //bail and fail
+
+  UINT64 x = 0; //integer so far
+
+  while(p < pEnd && *p >= '0' && *p <= '9'){ //for each digit
+    x = 10*x + (*p++ - '0');
+    if(x > 0xFFFFFFFFULL)return false; //too big
+  } //while
+
+  n = (UINT)x;
+  return true;
+} //ScanUint
+
+/// Append an unsigned integer to a string in decimal, without going through
+/// `printf` or a string stream. This is the opposite of `ScanUint()`.
+/// \param str [IN, OUT] String.
+/// \param n The integer.
+
+void AppendUint(std::string& str, UINT n){
+  char buf[10]; //digits in reverse order, enough for 32 bits
+  UINT k = 0; //number of digits
+
+  do{
+    buf[k++] = (char)('0' + n%10);
+    n /= 10;
+  }while(n > 0);
+
+  while(k > 0)
+    str.push_back(buf[--k]);
+} //AppendUint
@@ -26,11 +26,14 @@
 #ifndef __Helpers_h__
 #define __Helpers_h__
 
-#include "Includes.h"
+#include "Platform.h"
 
 bool odd(const UINT); ///< Parity test.
 bool IsPowerOf2(const UINT n); ///< Power of 2 test.
 UINT CeilLog2(const UINT n); ///< Ceiling of log base 2.
+UINT64 Fnv1a(const void*, const size_t, UINT64=14695981039346656037ULL); ///< FNV-1a hash.
+bool ScanUint(const char*&, const char*, UINT&); ///< Scan an unsigned integer.
+void AppendUint(std::string&, UINT); ///< Append an unsigned integer.
 
 #endif //__Helpers_h__
 
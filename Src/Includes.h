@@ -28,13 +28,10 @@
 
 #pragma comment(lib,"Gdiplus.lib")
 
-#include <windows.h>
+#include "Platform.h"
+
 #include <windowsx.h>
 #include <objidl.h>
 #include <gdiplus.h>
 
-#include <cmath>
-#include <string>
-#include <vector>
-
 #endif //__INCLUDES_H__
\ No newline at end of file
@@ -0,0 +1,177 @@
+/// \file IncrementalVerifier.cpp
+/// \brief Code for the incremental verifier CIncrementalVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "IncrementalVerifier.h"
+
+/// Delete the sets.
+
+CIncrementalVerifier::~CIncrementalVerifier(){
+  delete [] m_pSet;
+} //destructor
+
+/// Forget the comparator network and delete the sets, so that the next call
+/// to `Update()` starts from scratch.
+
+void CIncrementalVerifier::Reset(){
+  delete [] m_pSet;
+  m_pSet = nullptr;
+  m_nKept = 0;
+  m_pLevels.reset();
+} //Reset
+
+/// Set the most memory that the sets kept between updates may use. This
+/// doesn't include the set after the last level or the sets that are
+/// generated again on every update, and takes effect at the next update.
+/// \param n Memory limit in bytes.
+
+void CIncrementalVerifier::SetMaxBytes(const UINT64 n){
+  m_nMaxBytes = n;
+} //SetMaxBytes
+
+/// Bring the sets up to date with a comparator network. If the number of
+/// inputs or the depth has changed then all of the sets are recomputed,
+/// otherwise only the sets after the first level that differs from the
+/// comparator network given to the previous call and every level after it,
+/// or from the first level whose set wasn't kept if that is earlier. Sets
+/// are kept while their total size is within the memory limit.
+/// \param nInputs Number of inputs.
+/// \param vecLevel Array of `std::vector`s of min-max `CComparator`s.
+/// \param nDepth Number of entries in `vecLevel`.
+/// \return false if the sets won't fit into memory or memory ran out, in
+/// which case nothing is kept and `Verify()` must not be called.
+
+bool CIncrementalVerifier::Update(const UINT nInputs,
+  std::vector<CComparator>* vecLevel, const UINT nDepth)
+{
+  UINT nFirst = 0; //first level that has changed
+
+  if(m_pSet && nInputs == m_nInputs && nDepth == m_nDepth){ //same shape
+    while(nFirst < m_nDepth){ //look for a level that has changed
+      const std::vector<CComparator>& vecOld = m_pLevels->GetLevel(nFirst); //old level
+      const std::vector<CComparator>& vecNew = vecLevel[nFirst]; //new level
+      bool bSame = vecOld.size() == vecNew.size(); //whether unchanged
+
+      for(UINT c=0; c<vecOld.size() && bSame; c++) //for each comparator
+        bSame = vecOld[c].m_nMin == vecNew[c].m_nMin &&
+          vecOld[c].m_nMax == vecNew[c].m_nMax;
+
+      if(!bSame)break; //found one
+      ++nFirst;
+    } //while
+
+    for(UINT i=nFirst; i<m_nDepth; i++) //for each level that has changed
+      m_pLevels->SetLevel(i, vecLevel[i]);
+  } //if
+
+  else{ //start from scratch
+    Reset();
+
+    m_nInputs = nInputs;
+    m_nDepth = nDepth;
+    m_pLevels.reset(new CReachableSetVerifier(m_nInputs, vecLevel, m_nDepth));
+    m_pSet = new CVectorSet[m_nDepth];
+    m_vSetSize.assign(m_nDepth, 0);
+  } //else
+
+  if(m_nDepth == 0 || !m_pLevels->IsReady()){ //won't fit
+    Reset();
+    return false;
+  } //if
+
+  m_nKept = min(nFirst, m_nKept); //the first set to recompute
+  const UINT nStart = m_nKept; //for the record
+
+  UINT64 nBytes = 0; //memory used by kept sets
+
+  for(UINT i=0; i<m_nKept; i++)
+    nBytes += m_pSet[i].GetBytes();
+
+  for(UINT i=nStart; i<m_nDepth; i++){ //for each level that needs recomputing
+    if(i == 0)m_pLevels->FirstLevel(m_pSet[0]);
+    else m_pLevels->NextLevel(i, m_pSet[i - 1], m_pSet[i]);
+
+    if(m_pSet[i].IsFailed()){ //out of memory
+      Reset();
+      return false;
+    } //if
+
+    m_vSetSize[i] = m_pSet[i].GetCount();
+
+    if(m_nKept == i && nBytes + m_pSet[i].GetBytes() <= m_nMaxBytes){ //keep it
+      nBytes += m_pSet[i].GetBytes();
+      ++m_nKept;
+    } //if
+
+    if(i > m_nKept) //previous set isn't kept and is no longer needed
+      m_pSet[i - 1].Free();
+  } //for
+
+  m_nRecomputed = m_nDepth - nStart;
+  return true;
+} //Update
+
+/// Check whether the comparator network sorts all zero-one inputs by looking
+/// for an unsorted vector in the set after the last level. Assumes that
+/// `Update()` has returned true.
+/// \return true if it sorts.
+
+bool CIncrementalVerifier::Verify(){
+  m_vFailed.clear();
+  return !m_pSet[m_nDepth - 1].GetUnsorted(m_nInputs, m_vFailed);
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs as used. Other entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CIncrementalVerifier::GetUsage(CBitArray& bUsed) const{
+  m_pLevels->GetUsage(bUsed);
+} //GetUsage
+
+/// Get an input that isn't sorted, if there is one. This is whichever input
+/// first reached an unsorted vector after the last level.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted input was found.
+
+bool CIncrementalVerifier::GetCounterexample(std::vector<UINT>& vInput) const{
+  if(m_vFailed.empty())return false; //bail and fail
+  vInput = m_vFailed;
+  return true;
+} //GetCounterexample
+
+/// Get the number of distinct vectors after each level.
+/// \return Set size after each level.
+
+const std::vector<UINT64>& CIncrementalVerifier::GetSetSizes() const{
+  return m_vSetSize;
+} //GetSetSizes
+
+/// Get the number of levels whose sets were recomputed by the last call to
+/// `Update()`, which is a measure of how much work it did.
+/// \return Number of levels recomputed.
+
+const UINT CIncrementalVerifier::GetRecomputed() const{
+  return m_nRecomputed;
+} //GetRecomputed
@@ -0,0 +1,84 @@
+/// \file IncrementalVerifier.h
+/// \brief Interface for the incremental verifier CIncrementalVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __IncrementalVerifier_h__
+#define __IncrementalVerifier_h__
+
+#include <memory>
+
+#include "Platform.h"
+#include "ComparatorNetwork.h"
+#include "ReachableSetVerifier.h"
+
+/// \brief Incremental verifier.
+///
+/// `CIncrementalVerifier` tests whether a comparator network is a sorting
+/// network in the same way as `CReachableSetVerifier`, by computing the set of
+/// distinct zero-one vectors that can appear after each level, except that it
+/// keeps the set after every level instead of just the last one. When it is
+/// given the comparator network again after a comparator has been added or
+/// removed, it compares the levels with the ones it saw last time and only
+/// recomputes the sets from the first level that changed onward. The sets
+/// shrink quickly in most sorting networks, so an edit near the end is very
+/// much cheaper than verifying from scratch. The comparators, the record of
+/// which ones swap, and the code that generates each set belong to a
+/// `CReachableSetVerifier`, which is given the sets to generate into. The
+/// sets are kept only for as many of the first levels as fit into a memory
+/// limit, 1 GB unless `SetMaxBytes()` says otherwise. The sets after the
+/// other levels are generated again on every update, and each is deleted
+/// once the next has been generated from it, except for the last one, which
+/// `Verify()` needs. This is only ready if the `CReachableSetVerifier` is, and
+/// if memory runs out anyway then all the sets are deleted.
+
+class CIncrementalVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    std::unique_ptr<CReachableSetVerifier> m_pLevels; ///< Comparators and whether they swap.
+
+    CVectorSet* m_pSet = nullptr; ///< Set after each level.
+    UINT m_nKept = 0; ///< Number of levels whose sets are kept.
+    UINT64 m_nMaxBytes = 1ULL << 30; ///< Most memory kept for sets.
+    std::vector<UINT64> m_vSetSize; ///< Size of set after each level.
+    UINT m_nRecomputed = 0; ///< Number of levels recomputed by last update.
+
+    std::vector<UINT> m_vFailed; ///< Input that isn't sorted, if any.
+
+    void Reset(); ///< Forget everything.
+
+  public:
+    ~CIncrementalVerifier(); ///< Destructor.
+
+    bool Update(const UINT, std::vector<CComparator>*, const UINT); ///< Bring up to date.
+    void SetMaxBytes(const UINT64); ///< Set most memory kept for sets.
+
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    bool GetCounterexample(std::vector<UINT>&) const; ///< Get unsorted input.
+    const std::vector<UINT64>& GetSetSizes() const; ///< Get set sizes.
+    const UINT GetRecomputed() const; ///< Get number of levels recomputed.
+}; //CIncrementalVerifier
+
+#endif //__IncrementalVerifier_h__
@@ -0,0 +1,345 @@
+/// \file LaneKernels.cpp
+/// \brief Code for the lane-parallel zero-one kernels used by CBitSlicedVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "LaneKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+  #define LANEKERNELS_X86 ///< Compile the x86 SIMD kernels.
+
+  #include <immintrin.h>
+
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    #define TARGET_AVX2 ///< MSVC needs no flags for AVX2 intrinsics.
+    #define TARGET_AVX512 ///< MSVC needs no flags for AVX-512 intrinsics.
+  #else
+    #include <cpuid.h>
+    #define TARGET_AVX2 __attribute__((target("avx2"))) ///< Compile for AVX2.
+    #define TARGET_AVX512 __attribute__((target("avx512f"))) ///< Compile for AVX-512.
+  #endif
+#endif
+
+/// Bit patterns for the six least significant channels. Bit \f$b\f$ of the
+/// word for channel \f$j\f$ is bit \f$j\f$ of \f$b\f$, so between them these
+/// six channels take all 64 combinations of zeros and ones.
+
+const UINT64 g_nLane[6] = {
+  0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+  0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+}; //g_nLane
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernels
+
+#pragma region Kernels
+
+/// The portable kernel, which processes 64 inputs using plain 64-bit
+/// integer operations. A comparator between channels \f$j < k\f$ puts the AND
+/// of their values on channel \f$j\f$ and the OR on channel \f$k\f$. It swaps
+/// on the inputs for which channel \f$j\f$ is 1 and channel \f$k\f$ is 0.
+/// The outputs are sorted if no channel has a 1 where the next one has a 0.
+/// \param nMin Min channel of each comparator.
+/// \param nMax Max channel of each comparator.
+/// \param nSize Number of comparators.
+/// \param nInputs Number of inputs.
+/// \param nInput Input on each channel.
+/// \param nValue [OUT] Value on each channel.
+/// \param nSwapped [IN, OUT] Inputs on which each comparator swaps.
+/// \return true if all outputs are sorted.
+
+static bool ScalarKernel(const UINT* nMin, const UINT* nMax, const UINT nSize,
+  const UINT nInputs, const UINT64* nInput, UINT64* nValue, UINT64* nSwapped)
+{
+  for(UINT j=0; j<nInputs; j++) //load inputs
+    nValue[j] = nInput[j];
+
+  for(UINT c=0; c<nSize; c++){ //for each comparator
+    const UINT j = nMin[c]; //min channel
+    const UINT k = nMax[c]; //max channel
+
+    const UINT64 a = nValue[j]; //value on min channel
+    const UINT64 b = nValue[k]; //value on max channel
+
+    nSwapped[c] |= a & ~b; //swaps where min channel is 1 and max channel is 0
+    nValue[j] = a & b; //min
+    nValue[k] = a | b; //max
+  } //for
+
+  UINT64 nUnsorted = 0; //bits for unsorted outputs
+
+  for(UINT j=0; j+1<nInputs; j++) //for each adjacent pair of channels
+    nUnsorted |= nValue[j] & ~nValue[j + 1];
+
+  return nUnsorted == 0;
+} //ScalarKernel
+
+#ifdef LANEKERNELS_X86
+
+/// The AVX2 kernel, which does the same as `ScalarKernel()` on 256 inputs
+/// at a time using 256-bit registers. Each channel occupies 4 words.
+/// \param nMin Min channel of each comparator.
+/// \param nMax Max channel of each comparator.
+/// \param nSize Number of comparators.
+/// \param nInputs Number of inputs.
+/// \param nInput Input on each channel.
+/// \param nValue [OUT] Value on each channel.
+/// \param nSwapped [IN, OUT] Inputs on which each comparator swaps.
+/// \return true if all outputs are sorted.
+
+TARGET_AVX2 static bool Avx2Kernel(const UINT* nMin, const UINT* nMax,
+  const UINT nSize, const UINT nInputs, const UINT64* nInput, UINT64* nValue,
+  UINT64* nSwapped)
+{
+  __m256i* v = (__m256i*)nValue; //values as 256-bit registers
+  __m256i* s = (__m256i*)nSwapped; //swaps as 256-bit registers
+  const __m256i* x = (const __m256i*)nInput; //inputs as 256-bit registers
+
+  for(UINT j=0; j<nInputs; j++) //load inputs
+    _mm256_storeu_si256(v + j, _mm256_loadu_si256(x + j));
+
+  for(UINT c=0; c<nSize; c++){ //for each comparator
+    const UINT j = nMin[c]; //min channel
+    const UINT k = nMax[c]; //max channel
+
+    const __m256i a = _mm256_loadu_si256(v + j); //value on min channel
+    const __m256i b = _mm256_loadu_si256(v + k); //value on max channel
+
+    const __m256i t = _mm256_andnot_si256(b, a); //where it swaps
+    _mm256_storeu_si256(s + c, _mm256_or_si256(_mm256_loadu_si256(s + c), t));
+    _mm256_storeu_si256(v + j, _mm256_and_si256(a, b)); //min
+    _mm256_storeu_si256(v + k, _mm256_or_si256(a, b)); //max
+  } //for
+
+  __m256i u = _mm256_setzero_si256(); //bits for unsorted outputs
+
+  for(UINT j=0; j+1<nInputs; j++) //for each adjacent pair of channels
+    u = _mm256_or_si256(u, _mm256_andnot_si256(
+      _mm256_loadu_si256(v + j + 1), _mm256_loadu_si256(v + j)));
+
+  return _mm256_testz_si256(u, u) != 0;
+} //Avx2Kernel
+
+/// The AVX-512 kernel, which does the same as `ScalarKernel()` on 512 inputs
+/// at a time using 512-bit registers. Each channel occupies 8 words.
+/// \param nMin Min channel of each comparator.
+/// \param nMax Max channel of each comparator.
+/// \param nSize Number of comparators.
+/// \param nInputs Number of inputs.
+/// \param nInput Input on each channel.
+/// \param nValue [OUT] Value on each channel.
+/// \param nSwapped [IN, OUT] Inputs on which each comparator swaps.
+/// \return true if all outputs are sorted.
+
+TARGET_AVX512 static bool Avx512Kernel(const UINT* nMin, const UINT* nMax,
+  const UINT nSize, const UINT nInputs, const UINT64* nInput, UINT64* nValue,
+  UINT64* nSwapped)
+{
+  for(UINT j=0; j<nInputs; j++) //load inputs
+    _mm512_storeu_si512(nValue + 8*j, _mm512_loadu_si512(nInput + 8*j));
+
+  for(UINT c=0; c<nSize; c++){ //for each comparator
+    UINT64* pMin = nValue + 8*nMin[c]; //value on min channel
+    UINT64* pMax = nValue + 8*nMax[c]; //value on max channel
+    UINT64* pSwapped = nSwapped + 8*c; //where it swaps
+
+    const __m512i a = _mm512_loadu_si512(pMin);
+    const __m512i b = _mm512_loadu_si512(pMax);
+
+    const __m512i t = _mm512_andnot_si512(b, a); //where it swaps
+    _mm512_storeu_si512(pSwapped, _mm512_or_si512(_mm512_loadu_si512(pSwapped), t));
+    _mm512_storeu_si512(pMin, _mm512_and_si512(a, b)); //min
+    _mm512_storeu_si512(pMax, _mm512_or_si512(a, b)); //max
+  } //for
+
+  __m512i u = _mm512_setzero_si512(); //bits for unsorted outputs
+
+  for(UINT j=0; j+1<nInputs; j++) //for each adjacent pair of channels
+    u = _mm512_or_si512(u, _mm512_andnot_si512(
+      _mm512_loadu_si512(nValue + 8*(j + 1)), _mm512_loadu_si512(nValue + 8*j)));
+
+  return _mm512_test_epi64_mask(u, u) == 0;
+} //Avx512Kernel
+
+#endif //LANEKERNELS_X86
+
+#pragma endregion Kernels
+
+///////////////////////////////////////////////////////////////////////////////
+// Processor feature detection
+
+#pragma region Processor feature detection
+
+#ifdef LANEKERNELS_X86
+
+/// Execute the `cpuid` instruction.
+/// \param r [OUT] Registers eax, ebx, ecx, and edx, in that order.
+/// \param nLeaf Leaf, that is, the value of eax.
+/// \param nSubLeaf Sub-leaf, that is, the value of ecx.
+
+static void CpuId(int r[4], const int nLeaf, const int nSubLeaf){
+#if defined(_MSC_VER)
+  __cpuidex(r, nLeaf, nSubLeaf);
+#else
+  unsigned a = 0, b = 0, c = 0, d = 0; //eax, ebx, ecx, edx
+  __cpuid_count(nLeaf, nSubLeaf, a, b, c, d);
+  r[0] = (int)a; r[1] = (int)b; r[2] = (int)c; r[3] = (int)d;
+#endif
+} //CpuId
+
+/// Read extended control register 0, which tells us which register files
+/// the operating system saves on a context switch.
+/// \return Contents of XCR0.
+
+static UINT64 GetXCR0(){
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  unsigned lo = 0, hi = 0; //low and high halves
+  __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return ((UINT64)hi << 32) | lo;
+#endif
+} //GetXCR0
+
+/// Test for AVX2 support, which must come from both the processor and the
+/// operating system.
+/// \return true if AVX2 is supported.
+
+static bool HasAvx2(){
+  int r[4]; //registers
+  CpuId(r, 0, 0);
+  if(r[0] < 7)return false; //no extended features leaf
+
+  CpuId(r, 1, 0);
+  const bool bOSXSave = (r[2] & (1 << 27)) != 0; //OS uses xsave
+  const bool bAvx = (r[2] & (1 << 28)) != 0; //processor has AVX
+  if(!bOSXSave || !bAvx)return false;
+  if((GetXCR0() & 0x6) != 0x6)return false; //OS doesn't save YMM registers
+
+  CpuId(r, 7, 0);
+  return (r[1] & (1 << 5)) != 0; //AVX2 bit
+} //HasAvx2
+
+/// Test for AVX-512 Foundation support, which must come from both the
+/// processor and the operating system.
+/// \return true if AVX-512F is supported.
+
+static bool HasAvx512(){
+  if(!HasAvx2())return false; //AVX-512 without AVX2 isn't worth the trouble
+  if((GetXCR0() & 0xE6) != 0xE6)return false; //OS doesn't save ZMM registers
+
+  int r[4]; //registers
+  CpuId(r, 7, 0);
+  return (r[1] & (1 << 16)) != 0; //AVX-512F bit
+} //HasAvx512
+
+#endif //LANEKERNELS_X86
+
+#pragma endregion Processor feature detection
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch functions
+
+#pragma region Dispatch functions
+
+/// Test whether this processor (and its operating system) supports a kernel.
+/// The answer is computed once and remembered.
+/// \param k Kernel.
+/// \return true if the kernel can be used.
+
+bool KernelSupported(const eKernel k){
+#ifdef LANEKERNELS_X86
+  static const bool bAvx2 = HasAvx2(); //AVX2 supported
+  static const bool bAvx512 = HasAvx512(); //AVX-512 supported
+#else
+  const bool bAvx2 = false; //no AVX2
+  const bool bAvx512 = false; //no AVX-512
+#endif
+
+  switch(k){
+    case eKernel::Scalar: return true;
+    case eKernel::Avx2:   return bAvx2;
+    case eKernel::Avx512: return bAvx512;
+  } //switch
+
+  return false;
+} //KernelSupported
+
+/// Get the fastest kernel supported by this processor.
+/// \return The kernel with the widest lanes that can be used.
+
+eKernel BestKernel(){
+  if(KernelSupported(eKernel::Avx512))return eKernel::Avx512;
+  if(KernelSupported(eKernel::Avx2))return eKernel::Avx2;
+  return eKernel::Scalar;
+} //BestKernel
+
+/// Get the number of 64-bit words that a kernel uses for each channel.
+/// It processes 64 times this many inputs at once.
+/// \param k Kernel.
+/// \return Number of 64-bit words per channel.
+
+UINT KernelWords(const eKernel k){
+  switch(k){
+    case eKernel::Scalar: return 1;
+    case eKernel::Avx2:   return 4;
+    case eKernel::Avx512: return 8;
+  } //switch
+
+  return 1;
+} //KernelWords
+
+/// Get the kernel function. Falls back to the portable kernel if the
+/// requested one isn't supported by this processor.
+/// \param k Kernel.
+/// \return Pointer to the kernel function.
+
+LaneKernel GetKernel(const eKernel k){
+#ifdef LANEKERNELS_X86
+  if(KernelSupported(k))
+    switch(k){
+      case eKernel::Avx2:   return Avx2Kernel;
+      case eKernel::Avx512: return Avx512Kernel;
+      default: break;
+    } //switch
+#endif
+
+  return ScalarKernel;
+} //GetKernel
+
+/// Get the name of a kernel for display purposes.
+/// \param k Kernel.
+/// \return Kernel name.
+
+const std::string KernelName(const eKernel k){
+  switch(k){
+    case eKernel::Scalar: return "Scalar";
+    case eKernel::Avx2:   return "AVX2";
+    case eKernel::Avx512: return "AVX-512";
+  } //switch
+
+  return "Unknown";
+} //KernelName
+
+#pragma endregion Dispatch functions
@@ -0,0 +1,56 @@
+/// \file LaneKernels.h
+/// \brief Header for the lane-parallel zero-one kernels used by CBitSlicedVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __LaneKernels_h__
+#define __LaneKernels_h__
+
+#include "Platform.h"
+#include "Defines.h"
+
+/// \brief Lane kernel.
+///
+/// A lane kernel pushes a group of zero-one inputs through a comparator
+/// network and checks whether the outputs are sorted. The value on each
+/// channel is a run of `KernelWords()` consecutive 64-bit words, one bit per
+/// input, so that channel \f$j\f$ occupies words \f$jw\f$ through
+/// \f$jw + w - 1\f$ of the value array, where \f$w\f$ is the number of words
+/// per channel. The parameters are, in order, the min channel of each
+/// comparator, the max channel of each comparator, the number of comparators,
+/// the number of inputs, the input array, the value array, and the array
+/// of bits for inputs on which each comparator swaps, which is
+/// accumulated into. The return value is true if all of the outputs are sorted.
+
+typedef bool (*LaneKernel)(const UINT*, const UINT*, const UINT, const UINT,
+  const UINT64*, UINT64*, UINT64*);
+
+extern const UINT64 g_nLane[6]; ///< Bit patterns for the six least significant channels.
+
+bool KernelSupported(const eKernel); ///< Does this processor support a kernel?
+eKernel BestKernel(); ///< Get the fastest supported kernel.
+UINT KernelWords(const eKernel); ///< Number of 64-bit words per channel.
+LaneKernel GetKernel(const eKernel); ///< Get kernel function.
+const std::string KernelName(const eKernel); ///< Get kernel name.
+
+#endif //__LaneKernels_h__
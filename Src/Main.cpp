@@ -165,6 +165,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam){
             0, 0, SW_SHOW);
           break;
 
+        case IDM_HELP_SELFTEST: //test verification engines
+          g_pMain->SelfTest();
+          break;
+
         case IDM_HELP_ABOUT:  //show ABout dialog box.
           MessageBox(nullptr, 
             "Copyright © Ian Parberry, 2022.\nSource code available under the MIT License from https://github.com/Ian-Parberry/sortingnetworkviewer/.", 
@@ -0,0 +1,152 @@
+/// \file MappedFile.cpp
+/// \brief Code for the read-only memory-mapped file CMappedFile.
+
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #include <cstdlib>
+#endif
+
+#include "MappedFile.h"
+
+/// Unmap and close the file, if one is open.
+
+CMappedFile::~CMappedFile(){
+  Close();
+} //destructor
+
+/// Open a file and map all of it into memory for reading. Any file that
+/// was already open is closed first.
+/// \param lpwstr Null terminated wide file name.
+/// \return true if the file was opened and mapped.
+
+bool CMappedFile::Open(LPCWSTR lpwstr){
+  Close();
+
+#ifdef _WIN32
+  m_hFile = CreateFileW(lpwstr, GENERIC_READ, FILE_SHARE_READ, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if(m_hFile == INVALID_HANDLE_VALUE)return false; //bail and fail
+
+  LARGE_INTEGER n; //file size
+
+  if(!GetFileSizeEx(m_hFile, &n)){ //bail and fail
+    Close();
+    return false;
+  } //if
+
+  m_nSize = (size_t)n.QuadPart;
+
+  if(m_nSize > 0){ //can't map an empty file
+    m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(m_hMapping)m_pData = (const BYTE*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if(m_pData == nullptr){ //bail and fail
+      Close();
+      return false;
+    } //if
+  } //if
+
+#else
+  const size_t nLen = wcstombs(nullptr, lpwstr, 0); //length of narrow name
+  if(nLen == (size_t)-1)return false; //bail and fail
+
+  std::string strName(nLen, '\0'); //narrow file name
+  wcstombs(&strName[0], lpwstr, nLen + 1);
+
+  const int fd = open(strName.c_str(), O_RDONLY); //file descriptor
+  if(fd < 0)return false; //bail and fail
+
+  struct stat st; //file status
+
+  if(fstat(fd, &st) != 0){ //bail and fail
+    close(fd);
+    return false;
+  } //if
+
+  m_nSize = (size_t)st.st_size;
+
+  if(m_nSize > 0){ //can't map an empty file
+    void* p = mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(p == MAP_FAILED){ //bail and fail
+      close(fd);
+      m_nSize = 0;
+      return false;
+    } //if
+
+    madvise(p, m_nSize, MADV_SEQUENTIAL);
+    m_pData = (const BYTE*)p;
+  } //if
+
+  close(fd); //the mapping keeps the file open
+#endif
+
+  m_bOpen = true;
+  return true;
+} //Open
+
+/// Unmap and close the file, if one is open.
+
+void CMappedFile::Close(){
+#ifdef _WIN32
+  if(m_pData)UnmapViewOfFile(m_pData);
+  if(m_hMapping)CloseHandle(m_hMapping);
+  if(m_hFile != INVALID_HANDLE_VALUE)CloseHandle(m_hFile);
+
+  m_hMapping = nullptr;
+  m_hFile = INVALID_HANDLE_VALUE;
+#else
+  if(m_pData)munmap((void*)m_pData, m_nSize);
+#endif
+
+  m_pData = nullptr;
+  m_nSize = 0;
+  m_bOpen = false;
+} //Close
+
+/// Get a pointer to the contents of the file.
+/// \return Pointer to the first byte, or nullptr if the file is empty.
+
+const BYTE* CMappedFile::GetData() const{
+  return m_pData;
+} //GetData
+
+/// Get the size of the file.
+/// \return Size in bytes.
+
+const size_t CMappedFile::GetSize() const{
+  return m_nSize;
+} //GetSize
+
+/// Whether a file is open.
+/// \return true if a file is open.
+
+const bool CMappedFile::IsOpen() const{
+  return m_bOpen;
+} //IsOpen
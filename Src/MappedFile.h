@@ -0,0 +1,66 @@
+/// \file MappedFile.h
+/// \brief Interface for the read-only memory-mapped file CMappedFile.
+
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MappedFile_h__
+#define __MappedFile_h__
+
+#include "Platform.h"
+
+/// \brief Read-only memory-mapped file.
+///
+/// `CMappedFile` maps the whole of a file into memory for reading, so that
+/// it can be parsed in place without copying it into a buffer first. The
+/// operating system pages it in as it is read, and can read ahead since we
+/// tell it that access will be sequential. The mapping is released by
+/// `Close()` or by the destructor. An empty file can be opened, in which
+/// case there is no mapping and the size is zero.
+
+class CMappedFile{
+  private:
+#ifdef _WIN32
+    HANDLE m_hFile = INVALID_HANDLE_VALUE; ///< File handle.
+    HANDLE m_hMapping = nullptr; ///< File mapping handle.
+#endif
+
+    const BYTE* m_pData = nullptr; ///< Start of mapped file.
+    size_t m_nSize = 0; ///< Size of file in bytes.
+    bool m_bOpen = false; ///< Whether a file is open.
+
+  public:
+    CMappedFile() = default; ///< Default constructor.
+    CMappedFile(const CMappedFile&) = delete; ///< No copy constructor.
+    CMappedFile& operator=(const CMappedFile&) = delete; ///< No copy assignment.
+    ~CMappedFile(); ///< Destructor.
+
+    bool Open(LPCWSTR); ///< Open and map a file.
+    void Close(); ///< Unmap and close.
+
+    const BYTE* GetData() const; ///< Get pointer to contents.
+    const size_t GetSize() const; ///< Get size in bytes.
+    const bool IsOpen() const; ///< Whether a file is open.
+}; //CMappedFile
+
+#endif //__MappedFile_h__
@@ -0,0 +1,164 @@
+/// \file MatchArray.h
+/// \brief Interface and code for the matching array CMatchArray.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MatchArray_h__
+#define __MatchArray_h__
+
+#include "Platform.h"
+#include "Defines.h"
+#include "FlatArray.h"
+
+/// \brief Matching array.
+///
+/// `CMatchArray` stores the matching at each level of a comparator network,
+/// that is, entry \f$(i, j)\f$ is the channel joined to channel \f$j\f$ by a
+/// comparator at level \f$i\f$, or \f$j\f$ itself if there isn't one. The
+/// entries are channel indices, so they are stored as 8-bit integers if there
+/// are at most 256 channels, 16-bit integers if there are at most 65536, and
+/// 32-bit integers otherwise. A 16-input comparator network then needs only
+/// 16 bytes per level, so the whole matching of a typical one fits into a few
+/// cache lines. The width is chosen by `Create()`. Entries can be read and
+/// written one at a time through `operator()` and `Set()`, which check the
+/// width each time, while hot loops can get the underlying `CFlatArray` of
+/// the right type once with `GetArray()` and index it directly.
+
+class CMatchArray{
+  private:
+    eIndexWidth m_eWidth = eIndexWidth::Bits32; ///< Width of entries.
+    CFlatArray<UINT8> m_n8; ///< Entries if 8 bits wide.
+    CFlatArray<UINT16> m_n16; ///< Entries if 16 bits wide.
+    CFlatArray<UINT> m_n32; ///< Entries if 32 bits wide.
+
+  public:
+    /// Get the narrowest width that can hold every channel index.
+    /// \param nInputs Number of inputs.
+    /// \return Width of entries.
+
+    static eIndexWidth ChooseWidth(const UINT nInputs){
+      if(nInputs <= 0x100)return eIndexWidth::Bits8;
+      if(nInputs <= 0x10000)return eIndexWidth::Bits16;
+      return eIndexWidth::Bits32;
+    } //ChooseWidth
+
+    /// Create a matching array with no comparators, with the narrowest width
+    /// that can hold every channel index. Memory for the other widths
+    /// is released. If memory runs out, the matching array is left empty.
+    /// \param nDepth Number of levels.
+    /// \param nInputs Number of inputs.
+    /// \return true if the memory was allocated.
+
+    bool Create(const UINT nDepth, const UINT nInputs){
+      m_eWidth = ChooseWidth(nInputs);
+      bool ok = false; //success
+
+      m_n8 = CFlatArray<UINT8>();
+      m_n16 = CFlatArray<UINT16>();
+      m_n32 = CFlatArray<UINT>();
+
+      switch(m_eWidth){
+        case eIndexWidth::Bits8:  ok = m_n8.Create(nDepth, nInputs, 0);  break;
+        case eIndexWidth::Bits16: ok = m_n16.Create(nDepth, nInputs, 0); break;
+        case eIndexWidth::Bits32: ok = m_n32.Create(nDepth, nInputs, 0); break;
+      } //switch
+
+      if(!ok)return false; //bail and fail
+
+      for(UINT i=0; i<nDepth; i++) //for each level
+        for(UINT j=0; j<nInputs; j++) //for each channel
+          Set(i, j, j); //no comparator
+
+      return true;
+    } //Create
+
+    /// Get an entry.
+    /// \param i Level.
+    /// \param j Channel.
+    /// \return Channel joined to channel \f$j\f$ at level \f$i\f$.
+
+    UINT operator()(const UINT i, const UINT j) const{
+      switch(m_eWidth){
+        case eIndexWidth::Bits8:  return m_n8(i, j);
+        case eIndexWidth::Bits16: return m_n16(i, j);
+        default:                  return m_n32(i, j);
+      } //switch
+    } //operator()
+
+    /// Set an entry.
+    /// \param i Level.
+    /// \param j Channel.
+    /// \param k Channel joined to channel \f$j\f$ at level \f$i\f$.
+
+    void Set(const UINT i, const UINT j, const UINT k){
+      switch(m_eWidth){
+        case eIndexWidth::Bits8:  m_n8(i, j) = (UINT8)k;   break;
+        case eIndexWidth::Bits16: m_n16(i, j) = (UINT16)k; break;
+        case eIndexWidth::Bits32: m_n32(i, j) = k;         break;
+      } //switch
+    } //Set
+
+    /// Get the width of the entries.
+    /// \return Width of entries.
+
+    const eIndexWidth GetWidth() const{
+      return m_eWidth;
+    } //GetWidth
+
+    /// Get the underlying array, which must be of the type that matches
+    /// `GetWidth()`.
+    /// \tparam T `UINT8`, `UINT16`, or `UINT`.
+    /// \return The array of entries.
+
+    template<class T> const CFlatArray<T>& GetArray() const;
+
+    /// Whether there are no entries.
+    /// \return true if there are no entries.
+
+    const bool IsEmpty() const{
+      return m_n8.IsEmpty() && m_n16.IsEmpty() && m_n32.IsEmpty();
+    } //IsEmpty
+}; //CMatchArray
+
+/// Get the underlying array of 8-bit entries.
+/// \return The array of entries.
+
+template<> inline const CFlatArray<UINT8>& CMatchArray::GetArray() const{
+  return m_n8;
+} //GetArray
+
+/// Get the underlying array of 16-bit entries.
+/// \return The array of entries.
+
+template<> inline const CFlatArray<UINT16>& CMatchArray::GetArray() const{
+  return m_n16;
+} //GetArray
+
+/// Get the underlying array of 32-bit entries.
+/// \return The array of entries.
+
+template<> inline const CFlatArray<UINT>& CMatchArray::GetArray() const{
+  return m_n32;
+} //GetArray
+
+#endif //__MatchArray_h__
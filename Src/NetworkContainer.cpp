@@ -0,0 +1,283 @@
+/// \file NetworkContainer.cpp
+/// \brief Code for the network container reader CContainerReader and writer CContainerWriter.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstring>
+
+#include "NetworkContainer.h"
+#include "ComparatorNetwork.h"
+#include "Helpers.h"
+
+static const UINT g_nMagic = 0x43424E53; ///< "SNBC" for sorting network binary container.
+static const UINT g_nVersion = 1; ///< Container file format version.
+
+/// \brief Header of a network container file.
+
+struct CContainerHeader{
+  UINT m_nMagic = 0; ///< Magic number.
+  UINT m_nVersion = 0; ///< File format version.
+  UINT64 m_nReserved = 0; ///< Reserved, always zero.
+}; //CContainerHeader
+
+/// \brief Trailer of a network container file, which follows the index.
+
+struct CContainerTrailer{
+  UINT64 m_nCount = 0; ///< Number of networks.
+  UINT64 m_nIndexOffset = 0; ///< Offset of the index.
+  UINT64 m_nHash = 0; ///< Hash of the index and the two fields above.
+}; //CContainerTrailer
+
+static_assert(sizeof(CContainerHeader) == 16, "CContainerHeader must have no padding");
+static_assert(sizeof(CContainerTrailer) == 24, "CContainerTrailer must have no padding");
+
+/// Get the hash of the index of a container file, which also covers the
+/// number of networks and the offset of the index in the trailer.
+/// \param pIndex Pointer to the index.
+/// \param t Trailer.
+/// \return FNV-1a hash.
+
+static UINT64 IndexHash(const void* pIndex, const CContainerTrailer& t){
+  const UINT64 nHash = Fnv1a(pIndex, (size_t)t.m_nCount*sizeof(UINT64));
+  return Fnv1a(&t, 2*sizeof(UINT64), nHash);
+} //IndexHash
+
+////////////////////////////////////////////////////////////////////////////////
+// CContainerWriter functions
+
+/// Close the file, writing the index, if one is open.
+
+CContainerWriter::~CContainerWriter(){
+  Close();
+} //destructor
+
+/// Write bytes to the output file and advance the offset.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \return true if they were all written.
+
+bool CContainerWriter::Put(const void* p, const size_t n){
+  m_nOffset += n;
+  return fwrite(p, 1, n, m_pOutput) == n;
+} //Put
+
+/// Create a container file and write its header. Any file that was already
+/// open is closed first.
+/// \param lpwstr Null terminated wide file name.
+/// \return true if the file was created.
+
+bool CContainerWriter::Open(LPCWSTR lpwstr){
+  Close();
+
+  _wfopen_s(&m_pOutput, lpwstr, L"wb");
+  if(m_pOutput == nullptr)return false; //bail and fail
+
+  CContainerHeader h; //header
+  h.m_nMagic = g_nMagic;
+  h.m_nVersion = g_nVersion;
+
+  m_nOffset = 0;
+  m_vecOffset.clear();
+
+  return Put(&h, sizeof(h));
+} //Open
+
+/// Append a comparator network to the container file.
+/// \param net A comparator network.
+/// \return true if it was written.
+
+bool CContainerWriter::Append(const CComparatorNetwork& net){
+  if(m_pOutput == nullptr)return false; //bail and fail
+
+  net.GetBinaryImage(m_vecImage);
+  m_vecOffset.push_back(m_nOffset);
+
+  return Put(m_vecImage.data(), m_vecImage.size());
+} //Append
+
+/// Write the index and the trailer and close the file. The file isn't a
+/// valid container file until this has been done.
+/// \return true if a file was open and everything was written to it.
+
+bool CContainerWriter::Close(){
+  if(m_pOutput == nullptr)return false; //nothing to close
+
+  CContainerTrailer t; //trailer
+  t.m_nCount = m_vecOffset.size();
+  t.m_nIndexOffset = m_nOffset;
+  t.m_nHash = IndexHash(m_vecOffset.data(), t);
+
+  bool ok = Put(m_vecOffset.data(), m_vecOffset.size()*sizeof(UINT64));
+  ok = Put(&t, sizeof(t)) && ok;
+  ok = fclose(m_pOutput) == 0 && ok;
+
+  m_pOutput = nullptr;
+  m_vecOffset.clear();
+  m_vecOffset.shrink_to_fit();
+
+  return ok;
+} //Close
+
+/// Get the number of networks appended since the file was opened.
+/// \return Number of networks.
+
+const UINT64 CContainerWriter::GetCount() const{
+  return m_vecOffset.size();
+} //GetCount
+
+////////////////////////////////////////////////////////////////////////////////
+// CContainerReader functions
+
+/// Open and map a container file, and check its header, trailer, and index.
+/// Any file that was already open is closed first.
+/// \param lpwstr Null terminated wide file name.
+/// \return true if the file was opened and is a valid container file.
+
+bool CContainerReader::Open(LPCWSTR lpwstr){
+  Close();
+  if(!m_cFile.Open(lpwstr))return false; //bail and fail
+
+  const BYTE* p = m_cFile.GetData(); //file contents
+  const UINT64 n = m_cFile.GetSize(); //file size
+
+  CContainerHeader h; //header
+  CContainerTrailer t; //trailer
+
+  bool ok = n >= sizeof(h) + sizeof(t);
+
+  if(ok){
+    memcpy(&h, p, sizeof(h));
+    memcpy(&t, p + n - sizeof(t), sizeof(t));
+
+    ok = h.m_nMagic == g_nMagic && h.m_nVersion == g_nVersion &&
+      h.m_nReserved == 0 && t.m_nIndexOffset >= sizeof(h) &&
+      t.m_nIndexOffset <= n - sizeof(t) &&
+      (n - sizeof(t) - t.m_nIndexOffset)%sizeof(UINT64) == 0 &&
+      t.m_nCount == (n - sizeof(t) - t.m_nIndexOffset)/sizeof(UINT64) &&
+      IndexHash(p + t.m_nIndexOffset, t) == t.m_nHash;
+  } //if
+
+  if(!ok){ //bail and fail
+    Close();
+    return false;
+  } //if
+
+  m_pIndex = p + t.m_nIndexOffset;
+  m_nIndexOffset = t.m_nIndexOffset;
+  m_nCount = t.m_nCount;
+
+  return true;
+} //Open
+
+/// Unmap and close the container file, if one is open.
+
+void CContainerReader::Close(){
+  m_cFile.Close();
+
+  m_pIndex = nullptr;
+  m_nIndexOffset = 0;
+  m_nCount = 0;
+  m_nNext = 0;
+} //Close
+
+/// Get the offset of a network from the index.
+/// \param k Index of a network, which must be less than the number of networks.
+/// \return Offset of the network from the start of the file.
+
+const UINT64 CContainerReader::GetOffset(const UINT64 k) const{
+  UINT64 n; //offset
+  memcpy(&n, m_pIndex + k*sizeof(UINT64), sizeof(n));
+  return n;
+} //GetOffset
+
+/// Read the `k`th comparator network in the container file, counting from
+/// zero. This takes constant time plus the time to read the network.
+/// \param k Index of a network.
+/// \param net [OUT] Comparator network.
+/// \return true if there is a `k`th network and it was read.
+
+bool CContainerReader::Read(const UINT64 k, CComparatorNetwork& net) const{
+  if(k >= m_nCount)return false; //bail and fail
+
+  const UINT64 nBegin = GetOffset(k); //start of network
+  const UINT64 nEnd = k + 1 < m_nCount? GetOffset(k + 1): m_nIndexOffset; //end
+
+  if(nBegin < sizeof(CContainerHeader) || nBegin > nEnd || nEnd > m_nIndexOffset)
+    return false; //corrupt index
+
+  const BYTE* p = m_cFile.GetData() + nBegin; //binary image
+  const size_t n = (size_t)(nEnd - nBegin); //size of binary image
+
+  return CComparatorNetwork::IsBinaryImage(p, n) && net.ReadImage(p, n);
+} //Read
+
+/// Read the next comparator network in the container file, starting with
+/// the first one after `Open()` or the one set by `Seek()`. 
+/// \param net [OUT] Comparator network.
+/// \return true if there was a next network and it was read.
+
+bool CContainerReader::Next(CComparatorNetwork& net){
+  if(m_nNext >= m_nCount)return false; //no more
+  return Read(m_nNext++, net);
+} //Next
+
+/// Set the network to be read by the next call to `Next()`.
+/// \param k Index of a network.
+/// \return true if there is a `k`th network.
+
+bool CContainerReader::Seek(const UINT64 k){
+  if(k >= m_nCount)return false; //bail and fail
+
+  m_nNext = k;
+  return true;
+} //Seek
+
+/// Get the number of networks in the container file.
+/// \return Number of networks.
+
+const UINT64 CContainerReader::GetCount() const{
+  return m_nCount;
+} //GetCount
+
+/// Test whether file contents are a container file, that is, whether they
+/// start with the right magic number. The rest of the header, the trailer,
+/// and the index are only checked by `Open()`.
+/// \param p Pointer to the file contents.
+/// \param n Size of the file contents in bytes.
+/// \return true if the contents start like a container file.
+
+bool CContainerReader::IsContainerImage(const BYTE* p, const size_t n){
+  UINT nMagic = 0; //magic number
+  if(n < sizeof(UINT))return false; //too short
+
+  memcpy(&nMagic, p, sizeof(UINT));
+  return nMagic == g_nMagic;
+} //IsContainerImage
+
+/// Get the index of the network to be read by the next call to `Next()`.
+/// \return Index of the next network, or the number of networks if there are no more.
+
+const UINT64 CContainerReader::GetPosition() const{
+  return m_nNext;
+} //GetPosition
@@ -0,0 +1,104 @@
+/// \file NetworkContainer.h
+/// \brief Interface for the network container reader CContainerReader and writer CContainerWriter.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __NetworkContainer_h__
+#define __NetworkContainer_h__
+
+#include "Platform.h"
+#include "MappedFile.h"
+
+class CComparatorNetwork;
+
+/// \brief Network container writer.
+///
+/// `CContainerWriter` writes many comparator networks to a single container
+/// file, one after the other, in the binary format of
+/// `CComparatorNetwork::GetBinaryImage()`. The file starts with a 16-byte
+/// header (magic number, version, and reserved bytes) and ends with an index
+/// of the offsets of the networks followed by a 24-byte trailer (the number
+/// of networks, the offset of the index, and a hash of the index). Since the
+/// index is at the end, networks can be appended as they are produced
+/// without knowing in advance how many there will be. The index is kept in
+/// memory until `Close()` writes it, at 8 bytes per network.
+
+class CContainerWriter{
+  private:
+    FILE* m_pOutput = nullptr; ///< Output file.
+    UINT64 m_nOffset = 0; ///< Offset of the next network.
+    std::vector<UINT64> m_vecOffset; ///< Offset of each network so far.
+    std::vector<BYTE> m_vecImage; ///< Scratch binary image.
+
+    bool Put(const void*, const size_t); ///< Write bytes.
+
+  public:
+    CContainerWriter() = default; ///< Default constructor.
+    CContainerWriter(const CContainerWriter&) = delete; ///< No copy constructor.
+    CContainerWriter& operator=(const CContainerWriter&) = delete; ///< No copy assignment.
+    ~CContainerWriter(); ///< Destructor.
+
+    bool Open(LPCWSTR); ///< Create a container file.
+    bool Append(const CComparatorNetwork&); ///< Append a network.
+    bool Close(); ///< Write the index and close.
+
+    const UINT64 GetCount() const; ///< Get number of networks so far.
+}; //CContainerWriter
+
+/// \brief Network container reader.
+///
+/// `CContainerReader` reads comparator networks from a container file
+/// written by `CContainerWriter`. The file is memory-mapped, so the
+/// `k`th network can be found in constant time from the index and read
+/// straight from the mapping by `Read()`, and `Next()` streams through
+/// the networks in order using constant memory beyond the network being
+/// read into. The index is checked against its hash when the file is
+/// opened, and each network is checked against its own header as it is
+/// read.
+
+class CContainerReader{
+  private:
+    CMappedFile m_cFile; ///< Container file.
+    const BYTE* m_pIndex = nullptr; ///< Start of the index.
+    UINT64 m_nIndexOffset = 0; ///< Offset of the index.
+    UINT64 m_nCount = 0; ///< Number of networks.
+    UINT64 m_nNext = 0; ///< Index of the next network for `Next()`.
+
+    const UINT64 GetOffset(const UINT64) const; ///< Get offset from index.
+
+  public:
+    bool Open(LPCWSTR); ///< Open a container file.
+    void Close(); ///< Close.
+
+    bool Read(const UINT64, CComparatorNetwork&) const; ///< Read the kth network.
+    bool Next(CComparatorNetwork&); ///< Read the next network.
+    bool Seek(const UINT64); ///< Set the next network.
+
+    const UINT64 GetCount() const; ///< Get number of networks.
+    const UINT64 GetPosition() const; ///< Get index of the next network.
+
+    static bool IsContainerImage(const BYTE*, const size_t); ///< Test for container file contents.
+}; //CContainerReader
+
+#endif //__NetworkContainer_h__
@@ -38,7 +38,7 @@ COddEvenSort::COddEvenSort(const UINT log2n):
   m_nDepth = log2n*(log2n + 1)/2;
   m_nSize = m_nInputs*log2n*(log2n - 1)/4 + m_nInputs - 1;
 
-  CreateMatchArray(m_nInputs, m_nDepth);
+  CreateMatchArray(m_nInputs, m_nDepth, m_nInputs/2);
   CreateComparators();
   CreateValueArray();
   CreateUsageArray();
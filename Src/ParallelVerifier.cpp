@@ -0,0 +1,311 @@
+/// \file ParallelVerifier.cpp
+/// \brief Code for the multithreaded zero-one verifier CParallelVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ParallelVerifier.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// CGrayCodeWorker
+
+#pragma region CGrayCodeWorker
+
+/// Create the value, usage, and input arrays and mark all comparators unused.
+/// \param nInputs Number of inputs.
+/// \param nMatch Matching array indexed by level then channel.
+/// \param nDepth Depth.
+/// \param bFirstNormalForm Whether to walk the ternary Gray code.
+
+CGrayCodeWorker::CGrayCodeWorker(const UINT nInputs,
+  const CMatchArray& nMatch, const UINT nDepth, const bool bFirstNormalForm):
+  m_nInputs(nInputs), m_nDepth(nDepth), m_nMatch(nMatch)
+{
+  m_pGrayCode.reset(bFirstNormalForm? new CTernaryGrayCode: new CBinaryGrayCode);
+  m_pGrayCode->Initialize(m_nInputs);
+
+  m_nValue.Create(m_nDepth, m_nInputs, false);
+  m_bUsed.Create(m_nDepth, m_nInputs, false);
+  m_nInput = new UINT[m_nInputs];
+
+  Reset();
+} //constructor
+
+/// Delete the input array.
+
+CGrayCodeWorker::~CGrayCodeWorker(){
+  delete [] m_nInput;
+} //destructor
+
+/// Set the input and the values on every channel at every level to zero.
+/// The usage array is left alone so that it accumulates over ranges.
+
+void CGrayCodeWorker::Reset(){
+  m_nValue.Fill(0, m_nDepth, false);
+
+  for(UINT j=0; j<m_nInputs; j++)
+    m_nInput[j] = 0;
+
+  m_nZeros = m_nInputs;
+} //Reset
+
+/// Flip one bit of the input and propagate the change down the comparator
+/// network, as in `CSortingNetwork::flipinput()`. If the previous input was
+/// sorted, then the new one is sorted iff the flipped value comes out on the
+/// channel just past the last zero (if it is now a one) or on the last zero
+/// (if it is now a zero).
+/// \tparam T Type of entries in the matching array.
+/// \param nMatch Matching array.
+/// \param j Flip the input on this channel.
+/// \return true if it still sorts when the input is flipped.
+
+template<class T> bool CGrayCodeWorker::Flip(const CFlatArray<T>& nMatch, UINT j){
+  m_nInput[j] ^= 1; //flip the input
+  m_nZeros += 1 - 2*m_nInput[j]; //adjust zero count
+  const UINT nTarget = m_nZeros + m_nInput[j] - 1; //where it should end up
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    UINT64* nValue = m_nValue[i]; //values at this level
+    nValue[j >> 6] ^= 1ULL << (j & 63); //flip the value on channel j at that level
+
+    const UINT k = nMatch[i][j]; //the channel to which it is joined, if any
+
+    if(k != j && k < m_nInputs){
+      const bool bValue = (nValue[k >> 6] >> (k & 63)) & 1; //value on channel k
+
+      if((bValue && j>k) || !(bValue || j>k)){
+        UINT64* bUsed = m_bUsed[i]; //usage at this level
+        bUsed[j >> 6] |= 1ULL << (j & 63); //mark both used
+        bUsed[k >> 6] |= 1ULL << (k & 63);
+        j = k;
+      } //if
+    } //if
+  } //for
+
+  return j == nTarget;
+} //Flip
+
+/// Check whether the comparator network sorts the inputs whose ranks in
+/// the reflected binary (or ternary) Gray code lie in a contiguous range.
+/// We seek the Gray code generator to the first rank, set the inputs that
+/// are one in that word one at a time, then push the rest of the range
+/// through in Gray code order. Every input along the way is checked, including the ones used
+/// to get to the start of the range. Checks the stop flag every 4096 inputs.
+/// This picks the version of the loop for the width of the entries in the
+/// matching array.
+/// \param nFirst Rank of the first input in the range.
+/// \param nCount Number of inputs in the range.
+/// \param bStop [IN] Stop flag, set by another worker.
+/// \return false if an input was found that isn't sorted.
+
+bool CGrayCodeWorker::VerifyRange(const UINT64 nFirst, const UINT64 nCount,
+  std::atomic<bool>& bStop)
+{
+  switch(m_nMatch.GetWidth()){
+    case eIndexWidth::Bits8:  return VerifyRange(m_nMatch.GetArray<UINT8>(),  nFirst, nCount, bStop);
+    case eIndexWidth::Bits16: return VerifyRange(m_nMatch.GetArray<UINT16>(), nFirst, nCount, bStop);
+    default:                  return VerifyRange(m_nMatch.GetArray<UINT>(),   nFirst, nCount, bStop);
+  } //switch
+} //VerifyRange
+
+/// Check whether the comparator network sorts the inputs in a range, as
+/// in the other version of `VerifyRange()`, reading the matching
+/// array directly.
+/// \tparam T Type of entries in the matching array.
+/// \param nMatch Matching array.
+/// \param nFirst Rank of the first input in the range.
+/// \param nCount Number of inputs in the range.
+/// \param bStop [IN] Stop flag, set by another worker.
+/// \return false if an input was found that isn't sorted.
+
+template<class T> bool CGrayCodeWorker::VerifyRange(const CFlatArray<T>& nMatch,
+  const UINT64 nFirst, const UINT64 nCount, std::atomic<bool>& bStop)
+{
+  Reset(); //start from all zeros
+  m_pGrayCode->Seek(nFirst); //first word in the range
+
+  for(UINT j=0; j<m_nInputs; j++) //for each channel
+    if(m_pGrayCode->m_nGrayCodeWord[j + 1]) //if it should be a one
+      if(!Flip(nMatch, j))return false; //bail if it doesn't sort
+
+  for(UINT64 c=1; c<nCount; c++){ //for the rest of the range
+    if(!Flip(nMatch, m_pGrayCode->Next() - 1))return false; //bail if it doesn't sort
+
+    if((c & 0xFFF) == 0 && bStop.load(std::memory_order_relaxed))
+      break; //somebody else found one that doesn't sort
+  } //for
+
+  return true;
+} //VerifyRange
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs in any of the ranges verified so far as used. Other entries are
+/// left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CGrayCodeWorker::GetUsage(CBitArray& bUsed) const{
+  const UINT nWords = CBitArray::GetWords(m_nInputs); //words per level
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(UINT w=0; w<nWords; w++) //for each word, 64 channels at a time
+      bUsed[i][w] |= m_bUsed[i][w];
+} //GetUsage
+
+/// Get the current input, which is the one that isn't sorted if
+/// `VerifyRange()` has just returned false.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+
+void CGrayCodeWorker::GetInput(std::vector<UINT>& vInput) const{
+  vInput.assign(m_nInput, m_nInput + m_nInputs);
+} //GetInput
+
+#pragma endregion CGrayCodeWorker
+
+///////////////////////////////////////////////////////////////////////////////
+// CParallelVerifier
+
+#pragma region CParallelVerifier
+
+/// Decide how many threads to use and how to split the Gray code into 
+/// ranges, then create one worker per thread. There are at least eight ranges
+/// per thread if possible, but each range has at least 256 inputs. The binary
+/// Gray code has \f$2^n\f$ ranks for \f$n\f$ inputs. The ternary one, used
+/// for networks in first normal form, has one ternary digit per bit pair and
+/// a binary digit for the unpaired last bit if \f$n\f$ is odd, which is
+/// \f$3^{\lfloor n/2 \rfloor} 2^{n \bmod 2}\f$ ranks. The last range may
+/// be short if the number of ranges doesn't divide the number of ranks.
+/// \param nInputs Number of inputs.
+/// \param nMatch Matching array indexed by level then channel.
+/// \param nDepth Depth.
+/// \param bFirstNormalForm Whether the comparator network is in first normal form.
+/// \param nThreads Number of threads, or zero for one per hardware thread.
+
+CParallelVerifier::CParallelVerifier(const UINT nInputs,
+  const CMatchArray& nMatch, const UINT nDepth, const bool bFirstNormalForm,
+  const UINT nThreads):
+  m_nInputs(nInputs), m_nDepth(nDepth), m_nMatch(nMatch)
+{
+  m_nThreads = nThreads? nThreads: std::thread::hardware_concurrency();
+  m_nThreads = max(1U, m_nThreads); //safety
+
+  if(!IsReady())return; //bail out
+
+  if(bFirstNormalForm){ //ternary Gray code
+    m_nRanks = (m_nInputs & 1)? 2: 1; //unpaired last bit, if any
+
+    for(UINT i=0; i<m_nInputs/2; i++) //for each bit pair
+      m_nRanks *= 3;
+  } //if
+
+  else m_nRanks = 1ULL << m_nInputs; //binary Gray code
+
+  m_nRanges = 1;
+
+  while(m_nRanges < 8ULL*m_nThreads && m_nRanks/(2*m_nRanges) >= 256)
+    m_nRanges *= 2;
+
+  m_nRangeSize = (m_nRanks + m_nRanges - 1)/m_nRanges; //round up
+  m_nRanges = (m_nRanks + m_nRangeSize - 1)/m_nRangeSize; //none past the end
+  m_nThreads = (UINT)min((UINT64)m_nThreads, m_nRanges); //no idle threads
+
+  for(UINT t=0; t<m_nThreads; t++)
+    m_vecWorker.push_back(new CGrayCodeWorker(m_nInputs, m_nMatch, m_nDepth,
+      bFirstNormalForm));
+} //constructor
+
+/// Delete the workers.
+
+CParallelVerifier::~CParallelVerifier(){
+  for(CGrayCodeWorker* p: m_vecWorker)
+    delete p;
+} //destructor
+
+/// Whether there are few enough inputs for the ranks to fit into a `UINT64`.
+/// \return true if `Verify()` can be called.
+
+bool CParallelVerifier::IsReady() const{
+  return m_nInputs < 64;
+} //IsReady
+
+/// Thread function. Keep taking the next range and verifying it until
+/// there are no more ranges or some worker finds an unsorted input.
+/// \param pWorker Pointer to the worker for this thread.
+
+void CParallelVerifier::Run(CGrayCodeWorker* pWorker){
+  while(!m_bStop.load(std::memory_order_relaxed)){
+    const UINT64 r = m_nNextRange++; //next range
+    if(r >= m_nRanges)break; //none left
+
+    const UINT64 nFirst = r*m_nRangeSize; //rank of first input in range
+    const UINT64 nCount = min(m_nRangeSize, m_nRanks - nFirst); //last may be short
+
+    if(!pWorker->VerifyRange(nFirst, nCount, m_bStop))
+      if(!m_bStop.exchange(true)) //tell the others to stop, unless they know
+        m_pFailed = pWorker; //first to fail
+  } //while
+} //Run
+
+/// Check whether the comparator network sorts all zero-one inputs by running
+/// the workers on their own threads. The first worker runs on this thread.
+/// Assumes that `IsReady()` is true.
+/// \return true if it sorts.
+
+bool CParallelVerifier::Verify(){
+  m_nNextRange = 0;
+  m_bStop = false;
+  m_pFailed = nullptr;
+
+  std::vector<std::thread> vecThread; //worker threads
+
+  for(UINT t=1; t<m_nThreads; t++)
+    vecThread.push_back(std::thread(&CParallelVerifier::Run, this, m_vecWorker[t]));
+
+  Run(m_vecWorker[0]);
+
+  for(std::thread& t: vecThread)
+    t.join();
+
+  return !m_bStop;
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs for any worker as used. Other entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CParallelVerifier::GetUsage(CBitArray& bUsed) const{
+  for(CGrayCodeWorker* p: m_vecWorker)
+    p->GetUsage(bUsed);
+} //GetUsage
+
+/// Get the input that wasn't sorted from the first worker to find one.
+/// Since the workers run concurrently this isn't necessarily the one with
+/// the smallest rank, and it may differ from run to run.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted input was found.
+
+bool CParallelVerifier::GetCounterexample(std::vector<UINT>& vInput) const{
+  if(m_pFailed == nullptr)return false; //bail and fail
+  m_pFailed->GetInput(vInput);
+  return true;
+} //GetCounterexample
+
+#pragma endregion CParallelVerifier
@@ -0,0 +1,121 @@
+/// \file ParallelVerifier.h
+/// \brief Interface for the multithreaded zero-one verifier CParallelVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __ParallelVerifier_h__
+#define __ParallelVerifier_h__
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "Platform.h"
+#include "BinaryGrayCode.h"
+#include "TernaryGrayCode.h"
+#include "BitArray.h"
+#include "MatchArray.h"
+
+/// \brief Gray code worker.
+///
+/// `CGrayCodeWorker` pushes one zero-one input at a time through a comparator
+/// network in Gray code order using a private copy of the values on every 
+/// channel at every level and a private usage array, exactly the way that
+/// `CSortingNetwork::sortsGrayCode()` does, but only for one contiguous range
+/// of ranks of the Gray code at a time. If the comparator network is in first
+/// normal form it walks the ternary Gray code instead of the binary one,
+/// as `CSortingNetwork::sorts()` does. The matching array is shared with
+/// the comparator network and is only ever read, so any number of workers
+/// can run on their own threads at once.
+
+class CGrayCodeWorker{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    const CMatchArray& m_nMatch; ///< Matchings at each level (not owned).
+
+    CBitArray m_nValue; ///< Values at each level, indexed by level then channel.
+    CBitArray m_bUsed; ///< Whether comparators are used, indexed by level then channel.
+    UINT* m_nInput = nullptr; ///< Current zero-one input.
+    UINT m_nZeros = 0; ///< Number of zeros in the current input.
+
+    std::unique_ptr<CBinaryGrayCode> m_pGrayCode; ///< Gray code generator.
+
+    void Reset(); ///< Reset the input and values to all zeros.
+    template<class T> bool Flip(const CFlatArray<T>&, UINT); ///< Flip an input and check that it still sorts.
+    template<class T> bool VerifyRange(const CFlatArray<T>&, const UINT64,
+      const UINT64, std::atomic<bool>&); ///< Verify a range for one index width.
+
+  public:
+    CGrayCodeWorker(const UINT, const CMatchArray&, const UINT,
+      const bool); ///< Constructor.
+    ~CGrayCodeWorker(); ///< Destructor.
+
+    bool VerifyRange(const UINT64, const UINT64, std::atomic<bool>&); ///< Verify a range.
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    void GetInput(std::vector<UINT>&) const; ///< Get current input.
+}; //CGrayCodeWorker
+
+/// \brief Multithreaded zero-one verifier.
+///
+/// `CParallelVerifier` tests whether a comparator network is a sorting network
+/// using the _Zero-One Principle_, like `CSortingNetwork::sorts()`, by splitting
+/// the Gray code sequence of `CBinaryGrayCode` into contiguous ranges of ranks,
+/// or that of `CTernaryGrayCode` if the comparator network is in first normal
+/// form. The ranges are handed out to `CGrayCodeWorker`s, one per thread, and each
+/// worker takes a new range when it finishes the last one. There are several
+/// ranges per thread so that they all finish at about the same time. As soon
+/// as one worker finds an input that isn't sorted, all of them stop. The ranks
+/// must fit into a `UINT64`, so `IsReady()` refuses 64 or more inputs.
+
+class CParallelVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    const CMatchArray& m_nMatch; ///< Matchings at each level (not owned).
+
+    UINT m_nThreads = 1; ///< Number of worker threads.
+    UINT64 m_nRanks = 1; ///< Number of ranks in the Gray code.
+    UINT64 m_nRangeSize = 1; ///< Number of ranks in a range.
+    UINT64 m_nRanges = 1; ///< Number of ranges.
+
+    std::atomic<UINT64> m_nNextRange; ///< Next range to be handed out.
+    std::atomic<bool> m_bStop; ///< Set when an unsorted input has been found.
+
+    std::vector<CGrayCodeWorker*> m_vecWorker; ///< One worker per thread.
+    CGrayCodeWorker* m_pFailed = nullptr; ///< Worker that found an unsorted input.
+
+    void Run(CGrayCodeWorker*); ///< Thread function.
+
+  public:
+    CParallelVerifier(const UINT, const CMatchArray&, const UINT,
+      const bool, const UINT=0); ///< Constructor.
+    ~CParallelVerifier(); ///< Destructor.
+
+    bool IsReady() const; ///< Whether the ranks fit into 64 bits.
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    bool GetCounterexample(std::vector<UINT>&) const; ///< Get unsorted input.
+}; //CParallelVerifier
+
+#endif //__ParallelVerifier_h__
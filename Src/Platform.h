@@ -0,0 +1,126 @@
+/// \file Platform.h
+/// \brief Platform-neutral types and functions.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __Platform_h__
+#define __Platform_h__
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  typedef unsigned int UINT; ///< 32-bit unsigned integer.
+  typedef uint8_t UINT8; ///< 8-bit unsigned integer.
+  typedef uint16_t UINT16; ///< 16-bit unsigned integer.
+  typedef uint64_t UINT64; ///< 64-bit unsigned integer.
+  typedef uint8_t BYTE; ///< Byte.
+  typedef uint32_t DWORD; ///< 32-bit unsigned integer.
+  typedef int32_t HRESULT; ///< Result code.
+  typedef wchar_t WCHAR; ///< Wide character.
+  typedef wchar_t* LPWSTR; ///< Null terminated wide string.
+  typedef const wchar_t* LPCWSTR; ///< Null terminated constant wide string.
+
+  #define S_OK ((HRESULT)0) ///< Success result code.
+  #define E_FAIL ((HRESULT)0x80004005) ///< Failure result code.
+  #define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0) ///< Test result code for success.
+  #define FAILED(hr) (((HRESULT)(hr)) < 0) ///< Test result code for failure.
+
+  #define fprintf_s fprintf ///< The C library's `fprintf` does the same job.
+
+  /// Maximum of two values, which the Windows headers provide as a macro.
+  /// \param a A value.
+  /// \param b Another value of the same type.
+  /// \return The larger of the two.
+
+  template<class T> inline T max(const T a, const T b){
+    return a > b? a: b;
+  } //max
+
+  /// Minimum of two values, which the Windows headers provide as a macro.
+  /// \param a A value.
+  /// \param b Another value of the same type.
+  /// \return The smaller of the two.
+
+  template<class T> inline T min(const T a, const T b){
+    return a < b? a: b;
+  } //min
+
+  /// Convert a wide string to a multibyte string in the current locale.
+  /// \param lpwstr Null terminated wide string.
+  /// \param str [OUT] Multibyte string.
+  /// \return true if every character could be converted.
+
+  inline bool Narrow(LPCWSTR lpwstr, std::string& str){
+    const size_t n = wcstombs(nullptr, lpwstr, 0); //length of result
+    if(n == (size_t)-1)return false; //bail and fail
+
+    str.assign(n, '\0');
+    wcstombs(&str[0], lpwstr, n + 1);
+    return true;
+  } //Narrow
+
+  /// Open a file with a wide file name, which the Microsoft C library
+  /// provides. The file name and mode are converted to multibyte strings in
+  /// the current locale.
+  /// \param pFile [OUT] File pointer, or nullptr if the file couldn't be opened.
+  /// \param lpwstrName Null terminated wide file name.
+  /// \param lpwstrMode Null terminated wide mode string.
+  /// \return Zero if the file was opened, nonzero otherwise.
+
+  inline int _wfopen_s(FILE** pFile, LPCWSTR lpwstrName, LPCWSTR lpwstrMode){
+    *pFile = nullptr;
+
+    std::string strName, strMode; //narrow file name and mode
+    if(!Narrow(lpwstrName, strName) || !Narrow(lpwstrMode, strMode))
+      return 1; //bail and fail
+
+    *pFile = fopen(strName.c_str(), strMode.c_str());
+    return *pFile? 0: 1;
+  } //_wfopen_s
+
+  /// Rename a file with wide file names, which the Microsoft C library
+  /// provides. Unlike the Microsoft version, this replaces the new file
+  /// atomically if it already exists.
+  /// \param lpwstrOld Null terminated wide name of an existing file.
+  /// \param lpwstrNew Null terminated wide new file name.
+  /// \return Zero if the file was renamed, nonzero otherwise.
+
+  inline int _wrename(LPCWSTR lpwstrOld, LPCWSTR lpwstrNew){
+    std::string strOld, strNew; //narrow file names
+    if(!Narrow(lpwstrOld, strOld) || !Narrow(lpwstrNew, strNew))
+      return 1; //bail and fail
+
+    return rename(strOld.c_str(), strNew.c_str());
+  } //_wrename
+#endif
+
+#endif //__Platform_h__
@@ -0,0 +1,505 @@
+/// \file PngWriter.cpp
+/// \brief Code for the PNG file writer CPngWriter.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#include "PngWriter.h"
+
+#pragma region Checksums
+
+/// Compute or continue a CRC-32 checksum, as used by PNG chunks. The table
+/// of remainders is built the first time this is called.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \param crc Checksum so far, before complementing.
+/// \return Checksum including these bytes, before complementing.
+
+static UINT Crc32(const BYTE* p, const size_t n, UINT crc){
+  static const std::vector<UINT> vecTable = [](){
+    std::vector<UINT> v(256); //remainder for each byte
+
+    for(UINT i=0; i<256; i++){
+      UINT c = i; //remainder
+
+      for(UINT k=0; k<8; k++)
+        c = (c & 1)? 0xEDB88320 ^ (c >> 1): c >> 1;
+
+      v[i] = c;
+    } //for
+
+    return v;
+  }(); //vecTable
+
+  for(size_t i=0; i<n; i++)
+    crc = vecTable[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+
+  return crc;
+} //Crc32
+
+static const UINT ADLER_BASE = 65521; ///< Modulus for Adler-32.
+
+/// Compute or continue an Adler-32 checksum, as used by zlib streams.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \param nAdler Checksum so far.
+/// \return Checksum including these bytes.
+
+static UINT Adler32(const BYTE* p, size_t n, const UINT nAdler){
+  UINT a = nAdler & 0xFFFF; //sum of bytes
+  UINT b = nAdler >> 16; //sum of sums
+
+  while(n > 0){
+    const size_t m = min(n, (size_t)5552); //most bytes before b can overflow
+    n -= m;
+
+    for(size_t i=0; i<m; i++){
+      a += *p++;
+      b += a;
+    } //for
+
+    a %= ADLER_BASE;
+    b %= ADLER_BASE;
+  } //while
+
+  return (b << 16) | a;
+} //Adler32
+
+/// Combine the Adler-32 checksums of two strings of bytes into the
+/// checksum of the two strings one after the other.
+/// \param nAdler1 Checksum of the first string.
+/// \param nAdler2 Checksum of the second string.
+/// \param n2 Length of the second string.
+/// \return Checksum of both strings.
+
+static UINT Adler32Combine(const UINT nAdler1, const UINT nAdler2, const UINT64 n2){
+  const UINT64 r = n2%ADLER_BASE; //length of second string mod base
+  const UINT64 a1 = nAdler1 & 0xFFFF, b1 = nAdler1 >> 16; //first sums
+  const UINT64 a2 = nAdler2 & 0xFFFF, b2 = nAdler2 >> 16; //second sums
+
+  const UINT64 a = (a1 + a2 + ADLER_BASE - 1)%ADLER_BASE;
+  const UINT64 b = (r*a1 + b1 + b2 + ADLER_BASE - r)%ADLER_BASE;
+
+  return (UINT)((b << 16) | a);
+} //Adler32Combine
+
+#pragma endregion Checksums
+
+#pragma region Filtering
+
+/// Paeth predictor from the PNG specification.
+/// \param a Byte to the left.
+/// \param b Byte above.
+/// \param c Byte above and to the left.
+/// \return Whichever of `a`, `b`, and `c` is closest to `a + b - c`.
+
+static BYTE Paeth(const int a, const int b, const int c){
+  const int pa = abs(b - c); //distance from a
+  const int pb = abs(a - c); //distance from b
+  const int pc = abs(a + b - 2*c); //distance from c
+
+  if(pa <= pb && pa <= pc)return (BYTE)a;
+  else if(pb <= pc)return (BYTE)b;
+  else return (BYTE)c;
+} //Paeth
+
+/// Filter a row of 4-byte pixels with each of the None, Sub, Up, and Paeth
+/// filters and keep the one whose output has the smallest sum of absolute
+/// values when read as signed bytes.
+/// \param pRow The row.
+/// \param pPrev The row above, or `nullptr` for the first row.
+/// \param n Number of bytes in a row.
+/// \param pOut [OUT] Filter type byte followed by `n` filtered bytes.
+/// \param vecScratch Scratch space, which is resized to `n`.
+
+static void FilterRow(const BYTE* pRow, const BYTE* pPrev, const UINT n,
+  BYTE* pOut, std::vector<BYTE>& vecScratch)
+{
+  const BYTE nFilter[4] = {0, 1, 2, 4}; //filter types tried
+  UINT64 nBest = ~0ULL; //smallest sum so far
+  vecScratch.resize(n);
+
+  for(UINT f=0; f<4; f++){ //for each filter
+    BYTE* p = vecScratch.data(); //filtered bytes
+    UINT64 nSum = 0; //sum of absolute values
+
+    for(UINT i=0; i<n; i++){ //for each byte
+      const int a = i >= 4? pRow[i - 4]: 0; //left
+      const int b = pPrev? pPrev[i]: 0; //above
+      const int c = i >= 4 && pPrev? pPrev[i - 4]: 0; //above left
+
+      switch(nFilter[f]){
+        case 0: p[i] = pRow[i]; break;
+        case 1: p[i] = (BYTE)(pRow[i] - a); break;
+        case 2: p[i] = (BYTE)(pRow[i] - b); break;
+        case 4: p[i] = (BYTE)(pRow[i] - Paeth(a, b, c)); break;
+      } //switch
+
+      nSum += abs((int)(signed char)p[i]);
+    } //for
+
+    if(nSum < nBest){ //best so far
+      nBest = nSum;
+      pOut[0] = nFilter[f];
+      memcpy(pOut + 1, p, n);
+    } //if
+  } //for
+} //FilterRow
+
+#pragma endregion Filtering
+
+#pragma region Deflate
+
+/// \brief Bit writer.
+///
+/// Appends bits to a byte vector least significant bit first, which is
+/// the order that deflate uses.
+
+class CBitWriter{
+  private:
+    std::vector<BYTE>& m_vecOut; ///< Output bytes.
+    UINT64 m_nBits = 0; ///< Bits not yet output.
+    UINT m_nCount = 0; ///< Number of bits not yet output.
+
+  public:
+    /// Constructor.
+    /// \param v Output bytes.
+
+    CBitWriter(std::vector<BYTE>& v): m_vecOut(v){};
+
+    /// Append bits.
+    /// \param nBits Bits, least significant first.
+    /// \param n Number of bits, at most 32.
+
+    void Put(const UINT nBits, const UINT n){
+      m_nBits |= (UINT64)nBits << m_nCount;
+      m_nCount += n;
+
+      while(m_nCount >= 8){
+        m_vecOut.push_back((BYTE)m_nBits);
+        m_nBits >>= 8;
+        m_nCount -= 8;
+      } //while
+    } //Put
+
+    /// Pad with zero bits to a byte boundary.
+
+    void Align(){
+      if(m_nCount > 0)Put(0, 8 - m_nCount);
+    } //Align
+}; //CBitWriter
+
+/// Reverse the bits of a Huffman code, which deflate stores most
+/// significant bit first.
+/// \param nCode Code.
+/// \param n Number of bits.
+/// \return Code with its bits in reverse order.
+
+static UINT Reverse(UINT nCode, const UINT n){
+  UINT r = 0; //reversed code
+
+  for(UINT i=0; i<n; i++){
+    r = (r << 1) | (nCode & 1);
+    nCode >>= 1;
+  } //for
+
+  return r;
+} //Reverse
+
+/// Append a literal or length symbol in the fixed Huffman code.
+/// \param bw Bit writer.
+/// \param s Symbol, from 0 to 287.
+
+static void PutSymbol(CBitWriter& bw, const UINT s){
+  if(s < 144)bw.Put(Reverse(0x30 + s, 8), 8);
+  else if(s < 256)bw.Put(Reverse(0x190 + s - 144, 9), 9);
+  else if(s < 280)bw.Put(Reverse(s - 256, 7), 7);
+  else bw.Put(Reverse(0xC0 + s - 280, 8), 8);
+} //PutSymbol
+
+/// Append a match in the fixed Huffman code.
+/// \param bw Bit writer.
+/// \param nLen Match length, from 3 to 258.
+/// \param nDist Match distance, from 1 to 32768.
+
+static void PutMatch(CBitWriter& bw, const UINT nLen, const UINT nDist){
+  static const UINT nLenBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17,
+    19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const UINT nLenExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2,
+    2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const UINT nDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49,
+    65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577};
+  static const UINT nDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5,
+    5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  UINT k = 28; //length code
+  while(nLenBase[k] > nLen)k--;
+  PutSymbol(bw, 257 + k);
+  bw.Put(nLen - nLenBase[k], nLenExtra[k]);
+
+  k = 29; //distance code
+  while(nDistBase[k] > nDist)k--;
+  bw.Put(Reverse(k, 5), 5);
+  bw.Put(nDist - nDistBase[k], nDistExtra[k]);
+} //PutMatch
+
+/// Compress bytes into one deflate block, which is not the final block,
+/// followed by an empty stored block so that the output ends on a byte
+/// boundary. Uses greedy LZ77 matching with hash chains of 3-byte
+/// prefixes over a 32 KB window, and the fixed Huffman code.
+/// \param p Pointer to the bytes.
+/// \param n Number of bytes.
+/// \param vecOut [OUT] Compressed bytes.
+
+static void Deflate(const BYTE* p, const size_t n, std::vector<BYTE>& vecOut){
+  const UINT nWindow = 32768; //window size
+  const UINT nHashBits = 15; //bits in hash
+  const UINT nMaxChain = 32; //longest hash chain followed
+  const size_t nMaxMatch = 258; //longest match
+
+  std::vector<int> vecHead(1 << nHashBits, -1); //last position with each hash
+  std::vector<int> vecPrev(nWindow, -1); //previous position with same hash
+
+  vecOut.clear();
+  CBitWriter bw(vecOut);
+  bw.Put(0, 1); //not the final block
+  bw.Put(1, 2); //fixed Huffman code
+
+  size_t i = 0; //current position
+
+  while(i < n){
+    size_t nBestLen = 0; //length of longest match
+    size_t nBestDist = 0; //distance of longest match
+
+    if(i + 3 <= n){
+      const UINT h = ((p[i] << 16 | p[i + 1] << 8 | p[i + 2])*2654435761U) >>
+        (32 - nHashBits); //hash of the next 3 bytes
+      const size_t nMax = min(nMaxMatch, n - i); //longest possible match
+      int nCand = vecHead[h]; //candidate position
+
+      for(UINT nChain=0; nCand >= 0 && i - nCand <= nWindow && nChain < nMaxChain;
+        nChain++)
+      {
+        if(p[nCand + nBestLen] == p[i + nBestLen]){ //might be longer
+          size_t nLen = 0; //match length
+          while(nLen < nMax && p[nCand + nLen] == p[i + nLen])nLen++;
+
+          if(nLen > nBestLen){
+            nBestLen = nLen;
+            nBestDist = i - nCand;
+            if(nLen == nMax)break; //can't do better
+          } //if
+        } //if
+
+        nCand = vecPrev[nCand & (nWindow - 1)];
+      } //for
+
+      vecPrev[i & (nWindow - 1)] = vecHead[h];
+      vecHead[h] = (int)i;
+    } //if
+
+    if(nBestLen >= 3){ //match
+      PutMatch(bw, (UINT)nBestLen, (UINT)nBestDist);
+
+      for(size_t j=i+1; j<i+nBestLen && j+3<=n; j++){ //hash the matched bytes
+        const UINT h = ((p[j] << 16 | p[j + 1] << 8 | p[j + 2])*2654435761U) >>
+          (32 - nHashBits);
+        vecPrev[j & (nWindow - 1)] = vecHead[h];
+        vecHead[h] = (int)j;
+      } //for
+
+      i += nBestLen;
+    } //if
+
+    else PutSymbol(bw, p[i++]); //literal
+  } //while
+
+  PutSymbol(bw, 256); //end of block
+
+  bw.Put(0, 3); //empty stored block, not final
+  bw.Align();
+  bw.Put(0x0000, 16); //length
+  bw.Put(0xFFFF, 16); //complement of length
+} //Deflate
+
+#pragma endregion Deflate
+
+#pragma region CPngWriter functions
+
+/// Close the file if it is still open.
+
+CPngWriter::~CPngWriter(){
+  if(m_pOutput)fclose(m_pOutput);
+} //destructor
+
+/// Set the number of threads used to compress.
+/// \param n Number of threads, or zero for one per hardware thread.
+
+void CPngWriter::SetThreads(const UINT n){
+  m_nThreads = n;
+} //SetThreads
+
+/// Write a chunk: its length, type, data, and CRC-32.
+/// \param strType Four-character chunk type.
+/// \param p Pointer to the chunk data.
+/// \param n Number of bytes of chunk data.
+
+void CPngWriter::PutChunk(const char* strType, const BYTE* p, const size_t n){
+  const BYTE nLen[4] = {(BYTE)(n >> 24), (BYTE)(n >> 16), (BYTE)(n >> 8), (BYTE)n};
+  UINT crc = Crc32((const BYTE*)strType, 4, 0xFFFFFFFF);
+  crc = ~Crc32(p, n, crc);
+  const BYTE nCrc[4] = {(BYTE)(crc >> 24), (BYTE)(crc >> 16), (BYTE)(crc >> 8), (BYTE)crc};
+
+  bool ok = fwrite(nLen, 1, 4, m_pOutput) == 4;
+  ok = ok && fwrite(strType, 1, 4, m_pOutput) == 4;
+  ok = ok && (n == 0 || fwrite(p, 1, n, m_pOutput) == n);
+  ok = ok && fwrite(nCrc, 1, 4, m_pOutput) == 4;
+
+  if(!ok)m_bFailed = true;
+} //PutChunk
+
+/// Create a PNG file and write the signature, the header, and the start
+/// of the zlib stream.
+/// \param lpwstr Null terminated wide file name.
+/// \param w Image width in pixels.
+/// \param h Image height in pixels.
+/// \return True if the file was created.
+
+bool CPngWriter::Open(LPCWSTR lpwstr, const UINT w, const UINT h){
+  if(m_pOutput)fclose(m_pOutput);
+
+  m_nWidth = w;
+  m_nHeight = h;
+  m_nRows = 0;
+  m_nAdler = 1;
+  m_vecPrevRow.clear();
+  m_bFailed = false;
+
+  _wfopen_s(&m_pOutput, lpwstr, L"wb");
+  if(m_pOutput == nullptr)return false; //bail and fail
+
+  const BYTE nSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  if(fwrite(nSignature, 1, 8, m_pOutput) != 8)m_bFailed = true;
+
+  const BYTE nHeader[13] = {
+    (BYTE)(w >> 24), (BYTE)(w >> 16), (BYTE)(w >> 8), (BYTE)w,
+    (BYTE)(h >> 24), (BYTE)(h >> 16), (BYTE)(h >> 8), (BYTE)h,
+    8, 6, 0, 0, 0}; //8-bit RGBA, deflate, standard filters, not interlaced
+  PutChunk("IHDR", nHeader, 13);
+
+  const BYTE nZlib[2] = {0x78, 0x01}; //deflate with 32 KB window
+  PutChunk("IDAT", nZlib, 2);
+
+  return !m_bFailed;
+} //Open
+
+/// Write rows of the image, from the top down. The rows are split into
+/// pieces that are filtered and compressed in parallel, then written in
+/// order as IDAT chunks.
+/// \param p Pointer to the rows, 4 bytes per pixel in RGBA order with
+/// straight alpha, one row after another.
+/// \param nRows Number of rows.
+/// \return True if nothing has gone wrong so far.
+
+bool CPngWriter::WriteRows(const BYTE* p, const UINT nRows){
+  if(m_pOutput == nullptr || m_nRows + nRows > m_nHeight)return false;
+
+  const UINT nRowBytes = 4*m_nWidth; //bytes per row
+  const UINT nPieceRows = max(1U, (256*1024)/(nRowBytes + 1)); //rows per piece
+  const UINT nPieces = (nRows + nPieceRows - 1)/nPieceRows; //number of pieces
+
+  std::vector<std::vector<BYTE>> vecCompressed(nPieces); //compressed pieces
+  std::vector<UINT> vecAdler(nPieces); //Adler-32 of each filtered piece
+  std::vector<UINT64> vecLen(nPieces); //length of each filtered piece
+  std::atomic<UINT> nNext(0); //next piece to compress
+
+  auto Compress = [&](){ //compress pieces until there are none left
+    std::vector<BYTE> vecFiltered, vecScratch; //filtered rows, scratch
+
+    for(UINT k=nNext++; k<nPieces; k=nNext++){ //for each piece
+      const UINT j0 = k*nPieceRows; //first row
+      const UINT j1 = min(j0 + nPieceRows, nRows); //last row + 1
+      vecFiltered.resize((size_t)(j1 - j0)*(nRowBytes + 1));
+
+      for(UINT j=j0; j<j1; j++){ //for each row
+        const BYTE* pPrev = j > 0? p + (size_t)(j - 1)*nRowBytes: //row above
+          m_vecPrevRow.empty()? nullptr: m_vecPrevRow.data();
+        FilterRow(p + (size_t)j*nRowBytes, pPrev, nRowBytes,
+          &vecFiltered[(size_t)(j - j0)*(nRowBytes + 1)], vecScratch);
+      } //for
+
+      vecAdler[k] = Adler32(vecFiltered.data(), vecFiltered.size(), 1);
+      vecLen[k] = vecFiltered.size();
+      Deflate(vecFiltered.data(), vecFiltered.size(), vecCompressed[k]);
+    } //for
+  }; //Compress
+
+  UINT nThreads = m_nThreads? m_nThreads: std::thread::hardware_concurrency();
+  nThreads = max(1U, min(nThreads, nPieces)); //no idle threads
+
+  std::vector<std::thread> vecThread; //worker threads
+
+  for(UINT t=1; t<nThreads; t++) //the first worker runs on this thread
+    vecThread.push_back(std::thread(Compress));
+
+  Compress();
+
+  for(std::thread& t: vecThread)
+    t.join();
+
+  for(UINT k=0; k<nPieces; k++){ //for each piece, in order
+    PutChunk("IDAT", vecCompressed[k].data(), vecCompressed[k].size());
+    m_nAdler = Adler32Combine(m_nAdler, vecAdler[k], vecLen[k]);
+  } //for
+
+  if(nRows > 0)
+    m_vecPrevRow.assign(p + (size_t)(nRows - 1)*nRowBytes, p + (size_t)nRows*nRowBytes);
+
+  m_nRows += nRows;
+  return !m_bFailed;
+} //WriteRows
+
+/// Finish the zlib stream with an empty final block and the Adler-32
+/// checksum, write the end chunk, and close the file.
+/// \return True if every row was written and nothing went wrong.
+
+bool CPngWriter::Close(){
+  if(m_pOutput == nullptr)return false;
+
+  const UINT a = m_nAdler; //shorthand
+  const BYTE nEnd[6] = {0x03, 0x00, //empty final block with fixed Huffman code
+    (BYTE)(a >> 24), (BYTE)(a >> 16), (BYTE)(a >> 8), (BYTE)a};
+  PutChunk("IDAT", nEnd, 6);
+  PutChunk("IEND", nullptr, 0);
+
+  if(fclose(m_pOutput) != 0)m_bFailed = true;
+  m_pOutput = nullptr;
+
+  return !m_bFailed && m_nRows == m_nHeight;
+} //Close
+
+#pragma endregion CPngWriter functions
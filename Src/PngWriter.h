@@ -0,0 +1,75 @@
+/// \file PngWriter.h
+/// \brief Interface for the PNG file writer CPngWriter.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __PngWriter_h__
+#define __PngWriter_h__
+
+#include "Platform.h"
+
+/// \brief PNG file writer.
+///
+/// `CPngWriter` writes an 8-bit RGBA image to a PNG file without any
+/// help from a library. The rows can be supplied a batch at a time by
+/// calling `WriteRows()` as often as needed, so the whole image never has
+/// to be in memory at once. Each batch is split into pieces of about
+/// 256 KB that are filtered and compressed on separate threads. Each
+/// piece is filtered with whichever of the None, Sub, Up, and Paeth
+/// filters gives the smallest sum of absolute values for each row. It
+/// is then compressed into its own deflate block using LZ77 with hash
+/// chains and the fixed Huffman code, and padded to a byte boundary with
+/// an empty stored block. The compressed pieces can therefore simply be
+/// written one after the other as IDAT chunks, and their Adler-32
+/// checksums combined, to make a single zlib stream. The fixed Huffman
+/// code is nowhere near optimal in general. Images of comparator
+/// networks, however, are mostly long runs that LZ77 turns into a few
+/// long matches, so it costs very little here.
+
+class CPngWriter{
+  private:
+    FILE* m_pOutput = nullptr; ///< Output file.
+    UINT m_nWidth = 0; ///< Image width in pixels.
+    UINT m_nHeight = 0; ///< Image height in pixels.
+    UINT m_nRows = 0; ///< Number of rows written so far.
+    UINT m_nThreads = 0; ///< Number of threads, 0 for all.
+    UINT m_nAdler = 1; ///< Adler-32 checksum of the filtered rows so far.
+    std::vector<BYTE> m_vecPrevRow; ///< Last row written, for filtering.
+    bool m_bFailed = false; ///< True if a write has failed.
+
+    void PutChunk(const char*, const BYTE*, const size_t); ///< Write a chunk.
+
+  public:
+    CPngWriter() = default; ///< Default constructor.
+    CPngWriter(const CPngWriter&) = delete; ///< No copy constructor.
+    CPngWriter& operator=(const CPngWriter&) = delete; ///< No copy assignment.
+    ~CPngWriter(); ///< Destructor.
+
+    void SetThreads(const UINT); ///< Set number of threads.
+
+    bool Open(LPCWSTR, const UINT, const UINT); ///< Create a PNG file.
+    bool WriteRows(const BYTE*, const UINT); ///< Write rows.
+    bool Close(); ///< Finish and close.
+}; //CPngWriter
+
+#endif //__PngWriter_h__
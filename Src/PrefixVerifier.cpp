@@ -0,0 +1,294 @@
+/// \file PrefixVerifier.cpp
+/// \brief Code for the prefix reduction verifier CPrefixVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PrefixVerifier.h"
+
+//Rough costs per vector used to decide how many levels go into the prefix,
+//in arbitrary units. Pushing a vector through a level of the prefix costs a
+//hash table insertion plus a little per comparator, while pushing a vector
+//through the suffix costs its share of a transpose and of the lane kernel.
+
+static const double COSTINSERT = 64.0; ///< Cost of hash table insertion.
+static const double COSTPREFIX = 1.0; ///< Cost of a comparator in the prefix.
+static const double COSTLANE = 2.0; ///< Cost of transposing into lanes.
+static const double COSTSUFFIX = 3.0/64.0; ///< Cost of a comparator in the suffix.
+
+/// Transpose a \f$64 \times 64\f$ bit matrix in place, so that bit \f$j\f$ of
+/// word \f$i\f$ moves to bit \f$i\f$ of word \f$j\f$. This swaps successively
+/// smaller blocks across the diagonal, from \f$32 \times 32\f$ down to
+/// \f$1 \times 1\f$.
+/// \param a [IN, OUT] Array of 64 words.
+
+static void Transpose64(UINT64* a){
+  UINT64 m = 0x00000000FFFFFFFFULL; //mask for low half of each block
+
+  for(UINT j=32; j>0; j>>=1, m^=m<<j) //for each block size
+    for(UINT k=0; k<64; k=((k | j) + 1) & ~j){ //for each pair of rows
+      const UINT64 t = ((a[k] >> j) ^ a[k | j]) & m; //bits to swap
+
+      a[k] ^= t << j;
+      a[k | j] ^= t;
+    } //for
+} //Transpose64
+
+/// Flatten the comparators into arrays in level order, remembering where each
+/// level starts, and allocate space for a block of vectors.
+/// \param nInputs Number of inputs, at most 64.
+/// \param vecLevel Array of `std::vector`s of min-max `CComparator`s.
+/// \param nDepth Number of entries in `vecLevel`.
+/// \param nPrefix Number of levels in the prefix, or zero to choose
+/// automatically.
+/// \param k Lane kernel. The portable kernel is used instead if this
+/// processor doesn't support it.
+
+CPrefixVerifier::CPrefixVerifier(const UINT nInputs,
+  std::vector<CComparator>* vecLevel, const UINT nDepth, const UINT nPrefix,
+  const eKernel k):
+  m_nInputs(nInputs), m_nDepth(nDepth), m_nPrefix(nPrefix),
+  m_cPrefix(nInputs, vecLevel, nDepth)
+{
+  m_eKernel = KernelSupported(k)? k: eKernel::Scalar;
+  m_pKernel = GetKernel(m_eKernel);
+  m_nWords = KernelWords(m_eKernel);
+  m_nLanes = 64*m_nWords;
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    m_vStart.push_back(m_nSize);
+    m_nSize += (UINT)vecLevel[i].size();
+  } //for
+
+  m_vStart.push_back(m_nSize); //sentinel
+
+  m_nMin = new UINT[m_nSize];
+  m_nMax = new UINT[m_nSize];
+  m_nLevel = new UINT[m_nSize];
+  m_nSwapped = new UINT64[m_nSize*m_nWords];
+
+  UINT c = 0; //comparator index
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(auto& p: vecLevel[i]){ //for each comparator at that level
+      m_nMin[c] = p.m_nMin;
+      m_nMax[c] = p.m_nMax;
+      m_nLevel[c] = i;
+      ++c;
+    } //for
+
+  m_nVector = new UINT64[m_nLanes];
+  m_nOrigin = new UINT64[m_nLanes];
+  m_nInput = new UINT64[64*m_nWords]; //room for 64 channels
+  m_nValue = new UINT64[64*m_nWords];
+} //constructor
+
+/// Delete the comparator arrays and the block arrays.
+
+CPrefixVerifier::~CPrefixVerifier(){
+  delete [] m_nMin;
+  delete [] m_nMax;
+  delete [] m_nLevel;
+  delete [] m_nSwapped;
+
+  delete [] m_nVector;
+  delete [] m_nOrigin;
+  delete [] m_nInput;
+  delete [] m_nValue;
+} //destructor
+
+/// Whether the set of vectors after the first level is small enough to be
+/// stored, which bounds the size of all later sets.
+/// \return true if `Verify()` can be called.
+
+bool CPrefixVerifier::IsReady() const{
+  return m_cPrefix.IsReady();
+} //IsReady
+
+/// Whether memory ran out while computing the set after the prefix during
+/// `Verify()`, in which case it gave up.
+/// \return true if memory ran out.
+
+const bool CPrefixVerifier::OutOfMemory() const{
+  return m_cPrefix.OutOfMemory();
+} //OutOfMemory
+
+/// Decide whether to add the next level to the prefix. We guess that the next
+/// level will shrink the set by the same factor as the last one did, and
+/// compare the cost of pushing the current set through the next level and
+/// then the smaller set through the rest with the cost of pushing the
+/// current set through the suffix right now.
+/// \return true if it's worth adding the next level to the prefix.
+
+bool CPrefixVerifier::Extend() const{
+  const UINT i = m_cPrefix.GetLevels(); //next level
+  if(i >= m_nDepth)return false; //there isn't one
+
+  const std::vector<UINT64>& vSize = m_cPrefix.GetSetSizes(); //sizes so far
+  const UINT n = (UINT)vSize.size(); //number of sizes
+  const double s = (double)vSize[n - 1]; //current set size
+  const double r = (n > 1)? (double)vSize[n - 2]/s: 1.0; //last shrink factor
+
+  const double c = m_vStart[i + 1] - m_vStart[i]; //comparators on next level
+  const double suffix = m_nSize - m_vStart[i]; //comparators in suffix now
+  const double lane = COSTSUFFIX/m_nWords; //cost per comparator per lane
+
+  const double now = s*(COSTLANE + lane*suffix); //stop here
+  const double later = s*(COSTINSERT + COSTPREFIX*c) + 
+    (s/r)*(COSTLANE + lane*(suffix - c)); //go one more level
+
+  return later < now;
+} //Extend
+
+/// Push the current block of vectors through the suffix. Unused lanes get
+/// the all-zeros vector, which is sorted and makes no comparator swap. The
+/// vectors in each group of 64 lanes are transposed into one word per
+/// channel for the lane kernel. If any output isn't sorted, then the input
+/// attached to the first vector that isn't sorted is saved.
+/// \param nCount Number of vectors in the block.
+/// \return true if the suffix sorts every vector in the block.
+
+bool CPrefixVerifier::Flush(const UINT nCount){
+  for(UINT b=nCount; b<m_nLanes; b++) //pad with zeros
+    m_nVector[b] = 0;
+
+  for(UINT w=0; w<m_nWords; w++){ //for each word
+    UINT64* p = m_nVector + 64*w; //its vectors
+    Transpose64(p); //now word j is channel j
+
+    for(UINT j=0; j<m_nInputs; j++) //for each channel
+      m_nInput[j*m_nWords + w] = p[j];
+  } //for
+
+  const UINT s = m_vStart[m_nLevels]; //first comparator in suffix
+
+  if(m_pKernel(m_nMin + s, m_nMax + s, m_nSize - s, m_nInputs, m_nInput,
+    m_nValue, m_nSwapped + s*m_nWords))
+    return true; //sorted
+
+  for(UINT w=0; w<m_nWords; w++){ //for each word
+    UINT64 nUnsorted = 0; //bits for unsorted outputs
+
+    for(UINT j=0; j+1<m_nInputs; j++) //for each adjacent pair of channels
+      nUnsorted |= m_nValue[j*m_nWords + w] & ~m_nValue[(j + 1)*m_nWords + w];
+
+    if(nUnsorted){ //found one
+      UINT b = 0; //index of least significant one bit
+      while(!((nUnsorted >> b) & 1))++b;
+
+      const UINT64 nInput = m_nOrigin[64*w + b]; //input that reached it
+      m_vFailed.resize(m_nInputs);
+
+      for(UINT j=0; j<m_nInputs; j++) //for each channel
+        m_vFailed[j] = (UINT)(nInput >> j) & 1;
+
+      break;
+    } //if
+  } //for
+
+  return false;
+} //Flush
+
+/// Check whether the comparator network sorts all zero-one inputs by
+/// computing the set of vectors after the prefix, then pushing those vectors
+/// through the suffix one block at a time. The all-ones vector is sorted, so
+/// there is no need to push it. Bails out at the first block that doesn't
+/// sort. Assumes that `IsReady()` is true.
+/// \return true if it sorts, false if it doesn't or if memory ran out.
+
+bool CPrefixVerifier::Verify(){
+  m_vFailed.clear();
+
+  for(UINT c=0; c<m_nSize*m_nWords; c++) //nothing has swapped yet
+    m_nSwapped[c] = 0;
+
+  m_cPrefix.Begin(m_nPrefix != 1); //first level, and second unless told not to
+
+  if(m_nPrefix > 0) //number of levels is given
+    while(m_cPrefix.GetLevels() < m_nPrefix && m_cPrefix.Step());
+
+  else while(Extend() && m_cPrefix.Step()); //automatic
+
+  if(m_cPrefix.OutOfMemory())return false; //bail and fail
+
+  m_nLevels = min(m_cPrefix.GetLevels(), m_nDepth);
+
+  const CVectorSet& set = m_cPrefix.GetSet(); //set after prefix
+  UINT nCount = 0; //number of vectors in current block
+  UINT64 nInput = 0; //input attached to vector
+
+  for(UINT64 i=0; i<set.GetCapacity(); i++){ //for each slot
+    const UINT64 v = set.GetSlot(i, nInput); //vector in that slot
+
+    if(v != ~0ULL){ //not empty
+      m_nVector[nCount] = v;
+      m_nOrigin[nCount] = nInput;
+
+      if(++nCount == m_nLanes){ //block is full
+        if(!Flush(nCount))return false; //bail and fail
+        nCount = 0;
+      } //if
+    } //if
+  } //for
+
+  return nCount == 0 || Flush(nCount);
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs during `Verify()` as used, in the prefix or in the suffix. Other
+/// entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CPrefixVerifier::GetUsage(CBitArray& bUsed) const{
+  m_cPrefix.GetUsage(bUsed); //prefix
+
+  for(UINT c=m_vStart[m_nLevels]; c<m_nSize; c++){ //for each comparator in suffix
+    UINT64 n = 0; //inputs on which it swapped
+
+    for(UINT w=0; w<m_nWords; w++) //for each word
+      n |= m_nSwapped[c*m_nWords + w];
+
+    if(n){ //mark both channels used
+      bUsed.Set(m_nLevel[c], m_nMin[c]);
+      bUsed.Set(m_nLevel[c], m_nMax[c]);
+    } //if
+  } //for
+} //GetUsage
+
+/// Get an input that isn't sorted, if there is one. This is an input that
+/// reached the first vector found not to be sorted by the suffix.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted input was found.
+
+bool CPrefixVerifier::GetCounterexample(std::vector<UINT>& vInput) const{
+  if(m_vFailed.empty())return false; //bail and fail
+  vInput = m_vFailed;
+  return true;
+} //GetCounterexample
+
+/// Get the number of distinct vectors after each level of the prefix. The
+/// number of entries is the number of levels in the prefix.
+/// \return Set size after each level of the prefix.
+
+const std::vector<UINT64>& CPrefixVerifier::GetSetSizes() const{
+  return m_cPrefix.GetSetSizes();
+} //GetSetSizes
@@ -0,0 +1,98 @@
+/// \file PrefixVerifier.h
+/// \brief Interface for the prefix reduction verifier CPrefixVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __PrefixVerifier_h__
+#define __PrefixVerifier_h__
+
+#include "Platform.h"
+#include "ComparatorNetwork.h"
+#include "LaneKernels.h"
+#include "ReachableSetVerifier.h"
+
+/// \brief Prefix reduction verifier.
+///
+/// `CPrefixVerifier` tests whether a comparator network is a sorting network
+/// using the _Zero-One Principle_ by splitting it into a prefix made up of the
+/// first \f$k\f$ levels and a suffix made up of the rest. The set of distinct
+/// zero-one vectors that can appear after the prefix is computed with a
+/// `CReachableSetVerifier`, and then only those vectors are pushed through the
+/// suffix, 64 per word at a time, using a lane kernel like
+/// `CBitSlicedVerifier`. The comparator network sorts iff the suffix sorts
+/// every one of them. This generalizes the trick used by `CTernaryGrayCode`,
+/// which amounts to \f$k = 1\f$ for comparator networks in first normal form,
+/// to any comparator network and any \f$k\f$. 
+///
+/// The number of levels in the prefix can be set by the caller, or chosen
+/// automatically by adding levels to the prefix one at a time for as long as
+/// a simple cost model predicts that it will save more time in the suffix 
+/// than it costs to compute the smaller set. The set after the first level 
+/// has to fit into memory, so this is only ready if that set has at most
+/// \f$2^{25}\f$ vectors and there are at most 64 inputs.
+
+class CPrefixVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    UINT m_nPrefix = 0; ///< Requested number of levels in prefix, 0 for automatic.
+    UINT m_nLevels = 0; ///< Actual number of levels in prefix.
+    CReachableSetVerifier m_cPrefix; ///< Computes the set after the prefix.
+
+    eKernel m_eKernel = eKernel::Scalar; ///< Lane kernel.
+    LaneKernel m_pKernel = nullptr; ///< Lane kernel function.
+    UINT m_nWords = 1; ///< Number of 64-bit words per channel.
+    UINT m_nLanes = 64; ///< Number of vectors per block, 64 per word.
+
+    UINT m_nSize = 0; ///< Size (number of comparators).
+    UINT* m_nMin = nullptr; ///< Min channel of each comparator in level order.
+    UINT* m_nMax = nullptr; ///< Max channel of each comparator in level order.
+    UINT* m_nLevel = nullptr; ///< Level of each comparator.
+    std::vector<UINT> m_vStart; ///< Index of first comparator at each level.
+
+    UINT64* m_nVector = nullptr; ///< Vectors in current block, one per lane.
+    UINT64* m_nOrigin = nullptr; ///< Input attached to each vector in block.
+    UINT64* m_nInput = nullptr; ///< Transposed vectors, words per channel.
+    UINT64* m_nValue = nullptr; ///< Value on each channel for current block.
+    UINT64* m_nSwapped = nullptr; ///< Inputs on which each comparator swaps.
+
+    std::vector<UINT> m_vFailed; ///< Input that isn't sorted, if any.
+
+    bool Extend() const; ///< Is it worth adding a level to the prefix?
+    bool Flush(const UINT); ///< Push current block through the suffix.
+
+  public:
+    CPrefixVerifier(const UINT, std::vector<CComparator>*, const UINT,
+      const UINT=0, const eKernel=eKernel::Scalar); ///< Constructor.
+    ~CPrefixVerifier(); ///< Destructor.
+
+    bool IsReady() const; ///< Whether the set will fit into memory.
+    const bool OutOfMemory() const; ///< Whether memory ran out.
+
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    bool GetCounterexample(std::vector<UINT>&) const; ///< Get unsorted input.
+    const std::vector<UINT64>& GetSetSizes() const; ///< Get set sizes.
+}; //CPrefixVerifier
+
+#endif //__PrefixVerifier_h__
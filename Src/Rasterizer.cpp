@@ -0,0 +1,244 @@
+/// \file Rasterizer.cpp
+/// \brief Code for the software rasterizer CRasterizer.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+
+#include "Rasterizer.h"
+
+/// Get the length of the overlap of an interval with a pixel.
+/// \param a Start of interval.
+/// \param b End of interval, at least `a`.
+/// \param i Pixel, which covers \f$[i - 1/2, i + 1/2]\f$.
+/// \return Length of the overlap, from 0 to 1.
+
+static float Overlap(const float a, const float b, const int i){
+  const float fOverlap = min(b, i + 0.5f) - max(a, i - 0.5f);
+  return fOverlap > 0.0f? fOverlap: 0.0f;
+} //Overlap
+
+/// Create a transparent image, discarding the old one.
+/// \param nLeft Canvas x coordinate of the leftmost column.
+/// \param nTop Canvas y coordinate of the top row.
+/// \param w Width in pixels.
+/// \param h Height in pixels.
+
+void CRasterizer::Create(const int nLeft, const int nTop, const UINT w, const UINT h){
+  m_nLeft = nLeft;
+  m_nTop = nTop;
+  m_nWidth = w;
+  m_nHeight = h;
+  m_vecPixel.assign(4*(size_t)w*h, 0);
+} //Create
+
+/// Blend a color into a pixel, which must be in the image, with the
+/// source-over operator on premultiplied alpha.
+/// \param x Canvas x coordinate.
+/// \param y Canvas y coordinate.
+/// \param c Coverage, from 0 (none) to 255 (all).
+/// \param argb Color in 32-bit ARGB format.
+
+void CRasterizer::Blend(const int x, const int y, const UINT c, const UINT argb){
+  const UINT a = ((argb >> 24)*c + 127)/255; //alpha of color times coverage
+  if(a == 0)return; //nothing to do
+
+  const UINT na = 255 - a; //how much of the old pixel shows through
+  const UINT s[4] = {(argb >> 16) & 0xFF, (argb >> 8) & 0xFF, argb & 0xFF, 255};
+  BYTE* p = &m_vecPixel[4*((size_t)(y - m_nTop)*m_nWidth + (x - m_nLeft))];
+
+  for(UINT k=0; k<4; k++)
+    p[k] = (BYTE)((s[k]*a + p[k]*na + 127)/255);
+} //Blend
+
+/// Fill a rectangle. Each pixel is blended with the color in proportion to
+/// the area of the pixel that the rectangle covers.
+/// \param x0 Canvas x coordinate of one side.
+/// \param y0 Canvas y coordinate of one side.
+/// \param x1 Canvas x coordinate of the opposite side.
+/// \param y1 Canvas y coordinate of the opposite side.
+/// \param argb Color in 32-bit ARGB format.
+
+void CRasterizer::FillRect(float x0, float y0, float x1, float y1, const UINT argb){
+  if(x1 < x0)std::swap(x0, x1);
+  if(y1 < y0)std::swap(y0, y1);
+
+  const int i0 = max((int)std::floor(x0 + 0.5f), m_nLeft); //first column
+  const int i1 = min((int)std::ceil(x1 + 0.5f), m_nLeft + (int)m_nWidth); //last column + 1
+  const int j0 = max((int)std::floor(y0 + 0.5f), m_nTop); //first row
+  const int j1 = min((int)std::ceil(y1 + 0.5f), m_nTop + (int)m_nHeight); //last row + 1
+
+  for(int j=j0; j<j1; j++){ //for each row
+    const float fy = Overlap(y0, y1, j); //fraction of the row covered
+
+    for(int i=i0; i<i1; i++){ //for each column
+      const UINT c = (UINT)(255.0f*fy*Overlap(x0, x1, i) + 0.5f); //coverage
+      if(c > 0)Blend(i, j, c, argb);
+    } //for
+  } //for
+} //FillRect
+
+/// Draw a line with flat ends. Only horizontal and vertical lines are
+/// supported, since they are all that are needed to draw a comparator
+/// network. Other lines are ignored.
+/// \param x0 Canvas x coordinate of one end.
+/// \param y0 Canvas y coordinate of one end.
+/// \param x1 Canvas x coordinate of the other end.
+/// \param y1 Canvas y coordinate of the other end.
+/// \param fWidth Line width in pixels.
+/// \param argb Color in 32-bit ARGB format.
+
+void CRasterizer::DrawLine(float x0, float y0, float x1, float y1,
+  const float fWidth, const UINT argb)
+{
+  const float r = fWidth/2.0f; //half the line width
+
+  if(y0 == y1) //horizontal
+    FillRect(x0, y0 - r, x1, y0 + r, argb);
+
+  else if(x0 == x1) //vertical
+    FillRect(x0 - r, y0, x0 + r, y1, argb);
+} //DrawLine
+
+/// Make the stamp for a circle, which is the coverage of each pixel within
+/// `m_nStampRadius` of the pixel containing its center. The coverage is
+/// the fraction of an 8 by 8 grid of samples in the pixel that are inside
+/// the circle.
+/// \param fx Fractional part of center x coordinate.
+/// \param fy Fractional part of center y coordinate.
+/// \param r Radius.
+
+void CRasterizer::MakeStamp(const float fx, const float fy, const float r){
+  const int R = (int)std::ceil(r) + 1; //stamp radius in pixels
+  const int n = 2*R + 1; //stamp width and height
+  const UINT nSamples = 8; //samples per pixel in each direction
+
+  m_vecStamp.resize(n*n);
+  m_nStampRadius = R;
+  m_fStampX = fx;
+  m_fStampY = fy;
+  m_fStampR = r;
+
+  for(int dy=-R; dy<=R; dy++) //for each row of the stamp
+    for(int dx=-R; dx<=R; dx++){ //for each column of the stamp
+      UINT nCount = 0; //number of samples in the circle
+
+      for(UINT sy=0; sy<nSamples; sy++){
+        const float v = dy - 0.5f + (sy + 0.5f)/nSamples - fy; //y relative to center
+
+        for(UINT sx=0; sx<nSamples; sx++){
+          const float u = dx - 0.5f + (sx + 0.5f)/nSamples - fx; //x relative to center
+          if(u*u + v*v <= r*r)nCount++;
+        } //for
+      } //for
+
+      m_vecStamp[(dy + R)*n + dx + R] =
+        (BYTE)((255*nCount + nSamples*nSamples/2)/(nSamples*nSamples));
+    } //for
+} //MakeStamp
+
+/// Fill a circle.
+/// \param x Canvas x coordinate of center.
+/// \param y Canvas y coordinate of center.
+/// \param d Diameter.
+/// \param argb Color in 32-bit ARGB format.
+
+void CRasterizer::FillCircle(const float x, const float y, const float d,
+  const UINT argb)
+{
+  const int ix = (int)std::floor(x); //column containing center
+  const int iy = (int)std::floor(y); //row containing center
+  const float fx = x - ix; //fractional part of x
+  const float fy = y - iy; //fractional part of y
+  const float r = d/2.0f; //radius
+
+  if(fx != m_fStampX || fy != m_fStampY || r != m_fStampR)
+    MakeStamp(fx, fy, r);
+
+  const int R = m_nStampRadius; //shorthand
+  const int n = 2*R + 1; //stamp width and height
+
+  const int i0 = max(ix - R, m_nLeft); //first column
+  const int i1 = min(ix + R + 1, m_nLeft + (int)m_nWidth); //last column + 1
+  const int j0 = max(iy - R, m_nTop); //first row
+  const int j1 = min(iy + R + 1, m_nTop + (int)m_nHeight); //last row + 1
+
+  for(int j=j0; j<j1; j++) //for each row
+    for(int i=i0; i<i1; i++){ //for each column
+      const UINT c = m_vecStamp[(j - iy + R)*n + i - ix + R]; //coverage
+      if(c > 0)Blend(i, j, c, argb);
+    } //for
+} //FillCircle
+
+/// Convert the pixels from premultiplied alpha to straight alpha, which is
+/// what PNG files use. Nothing should be drawn after this.
+
+void CRasterizer::Unpremultiply(){
+  for(size_t k=0; k<m_vecPixel.size(); k+=4){ //for each pixel
+    BYTE* p = &m_vecPixel[k]; //the pixel
+    const UINT a = p[3]; //alpha
+
+    if(a == 0)
+      p[0] = p[1] = p[2] = 0;
+
+    else if(a < 255)
+      for(UINT c=0; c<3; c++) //for each color channel
+        p[c] = (BYTE)min(255U, (p[c]*255 + a/2)/a);
+  } //for
+} //Unpremultiply
+
+/// Reader function for the canvas x coordinate of the leftmost column.
+/// \return Canvas x coordinate of the leftmost column.
+
+const int CRasterizer::GetLeft() const{
+  return m_nLeft;
+} //GetLeft
+
+/// Reader function for the canvas y coordinate of the top row.
+/// \return Canvas y coordinate of the top row.
+
+const int CRasterizer::GetTop() const{
+  return m_nTop;
+} //GetTop
+
+/// Reader function for the width.
+/// \return Width in pixels.
+
+const UINT CRasterizer::GetWidth() const{
+  return m_nWidth;
+} //GetWidth
+
+/// Reader function for the height.
+/// \return Height in pixels.
+
+const UINT CRasterizer::GetHeight() const{
+  return m_nHeight;
+} //GetHeight
+
+/// Get a pointer to a row of pixels, 4 bytes per pixel in RGBA order.
+/// \param j Row, from 0 at the top of the image.
+/// \return Pointer to the first pixel of row `j`.
+
+const BYTE* CRasterizer::GetRow(const UINT j) const{
+  return &m_vecPixel[4*(size_t)j*m_nWidth];
+} //GetRow
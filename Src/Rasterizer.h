@@ -0,0 +1,83 @@
+/// \file Rasterizer.h
+/// \brief Interface for the software rasterizer CRasterizer.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __Rasterizer_h__
+#define __Rasterizer_h__
+
+#include "Platform.h"
+
+/// \brief Software rasterizer.
+///
+/// `CRasterizer` draws anti-aliased axis-aligned lines and filled circles,
+/// which is all that a comparator network needs, into an RGBA image in
+/// memory without any help from the operating system. It follows the GDI+
+/// conventions so that the result looks like what `Gdiplus::Graphics`
+/// draws in high quality smoothing mode: pixel \f$(i, j)\f$ is the unit
+/// square centered at \f$(i, j)\f$, lines have flat ends, and colors are
+/// 32-bit ARGB. The coverage of each pixel by a line is computed exactly,
+/// and by a circle from 64 samples per pixel. The coverage of a circle
+/// depends only on the fractional part of its center, so it is kept in a
+/// stamp that is computed again only when that changes.
+///
+/// The image is a window onto a larger canvas, with its top left pixel
+/// at `(m_nLeft, m_nTop)`, and anything outside it is clipped. The pixels
+/// are kept with premultiplied alpha while drawing, which makes blending
+/// a multiply-add, and are converted to straight alpha for output by
+/// `Unpremultiply()`.
+
+class CRasterizer{
+  private:
+    int m_nLeft = 0; ///< Canvas x coordinate of the leftmost column.
+    int m_nTop = 0; ///< Canvas y coordinate of the top row.
+    UINT m_nWidth = 0; ///< Width in pixels.
+    UINT m_nHeight = 0; ///< Height in pixels.
+    std::vector<BYTE> m_vecPixel; ///< RGBA pixels, row by row.
+
+    std::vector<BYTE> m_vecStamp; ///< Coverage of a circle.
+    int m_nStampRadius = 0; ///< Stamp extends this far from its center pixel.
+    float m_fStampX = -1.0f; ///< Fractional part of center x for the stamp.
+    float m_fStampY = -1.0f; ///< Fractional part of center y for the stamp.
+    float m_fStampR = -1.0f; ///< Radius for the stamp.
+
+    void Blend(const int, const int, const UINT, const UINT); ///< Blend a pixel.
+    void MakeStamp(const float, const float, const float); ///< Make circle stamp.
+
+  public:
+    void Create(const int, const int, const UINT, const UINT); ///< Create blank image.
+
+    void FillRect(float, float, float, float, const UINT); ///< Fill a rectangle.
+    void DrawLine(float, float, float, float, const float, const UINT); ///< Draw a line.
+    void FillCircle(const float, const float, const float, const UINT); ///< Fill a circle.
+
+    void Unpremultiply(); ///< Convert to straight alpha.
+
+    const int GetLeft() const; ///< Get canvas x coordinate of left column.
+    const int GetTop() const; ///< Get canvas y coordinate of top row.
+    const UINT GetWidth() const; ///< Get width.
+    const UINT GetHeight() const; ///< Get height.
+    const BYTE* GetRow(const UINT) const; ///< Get pointer to a row.
+}; //CRasterizer
+
+#endif //__Rasterizer_h__
@@ -0,0 +1,531 @@
+/// \file ReachableSetVerifier.cpp
+/// \brief Code for the reachable set verifier CReachableSetVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <new>
+
+#include "ReachableSetVerifier.h"
+
+static const UINT64 MAXFIRSTCOUNT = 1ULL << 25; ///< Largest set after first level.
+
+///////////////////////////////////////////////////////////////////////////////
+// CVectorSet
+
+#pragma region CVectorSet
+
+/// Delete the key and input arrays.
+
+CVectorSet::~CVectorSet(){
+  delete [] m_nKey;
+  delete [] m_nInput;
+} //destructor
+
+/// Make the set empty, with enough slots for a given number of keys at a
+/// load factor of at most one half. The arrays are only reallocated if they
+/// are too small. If they can't be allocated, the set is marked as failed
+/// and has no slots.
+/// \param n Number of keys to make room for.
+
+void CVectorSet::Clear(const UINT64 n){
+  UINT64 nCapacity = 16; //new capacity
+  UINT nShift = 60; //new shift for hash function
+
+  while(nCapacity < 2*n){
+    nCapacity *= 2;
+    --nShift;
+  } //while
+
+  if(nCapacity > m_nCapacity){ //need more slots
+    delete [] m_nKey;
+    delete [] m_nInput;
+
+    m_nKey = new (std::nothrow) UINT64[nCapacity];
+    m_nInput = new (std::nothrow) UINT64[nCapacity];
+    m_nCapacity = nCapacity;
+    m_nShift = nShift;
+
+    if(m_nKey == nullptr || m_nInput == nullptr){ //bail and fail
+      delete [] m_nKey;
+      delete [] m_nInput;
+      m_nKey = m_nInput = nullptr;
+      m_nCapacity = 0;
+      m_nCount = 0;
+      m_bOnes = false;
+      m_bFailed = true;
+      return;
+    } //if
+  } //if
+
+  for(UINT64 i=0; i<m_nCapacity; i++)
+    m_nKey[i] = ~0ULL; //empty
+
+  m_nCount = 0;
+  m_bOnes = false;
+  m_bFailed = false;
+} //Clear
+
+/// Make the set empty and delete the key and input arrays, so that it uses
+/// no memory until the next call to `Clear()`.
+
+void CVectorSet::Free(){
+  delete [] m_nKey;
+  delete [] m_nInput;
+  m_nKey = m_nInput = nullptr;
+
+  m_nCapacity = 0;
+  m_nShift = 64;
+  m_nCount = 0;
+  m_bOnes = false;
+  m_bFailed = false;
+} //Free
+
+/// Double the capacity and reinsert the keys. If the new arrays can't be
+/// allocated, the set is marked as failed and keeps the old ones.
+
+void CVectorSet::Grow(){
+  const UINT64 nCapacity = 2*m_nCapacity; //new capacity
+  UINT64* nKey = new (std::nothrow) UINT64[nCapacity]; //new keys
+  UINT64* nInput = new (std::nothrow) UINT64[nCapacity]; //new inputs
+
+  if(nKey == nullptr || nInput == nullptr){ //bail and fail
+    delete [] nKey;
+    delete [] nInput;
+    m_bFailed = true;
+    return;
+  } //if
+
+  UINT64* nOldKey = m_nKey; //old keys
+  UINT64* nOldInput = m_nInput; //old inputs
+  const UINT64 nOldCapacity = m_nCapacity; //old capacity
+
+  m_nKey = nKey;
+  m_nInput = nInput;
+  m_nCapacity = nCapacity;
+  --m_nShift;
+  m_nCount = m_bOnes? 1: 0;
+
+  for(UINT64 i=0; i<m_nCapacity; i++)
+    m_nKey[i] = ~0ULL; //empty
+
+  for(UINT64 i=0; i<nOldCapacity; i++)
+    if(nOldKey[i] != ~0ULL)
+      Insert(nOldKey[i], nOldInput[i]);
+
+  delete [] nOldKey;
+  delete [] nOldInput;
+} //Grow
+
+/// Insert a key into the set, unless it is already there. The slot is found
+/// with a multiplicative hash and linear probing. Does nothing if an
+/// allocation has failed.
+/// \param nKey Key.
+/// \param nInput Input to attach to the key if it is new.
+
+void CVectorSet::Insert(const UINT64 nKey, const UINT64 nInput){
+  if(m_bFailed)return; //bail out
+
+  if(nKey == ~0ULL){ //all ones
+    if(!m_bOnes){
+      m_bOnes = true;
+      m_nOnesInput = nInput;
+      ++m_nCount;
+    } //if
+
+    return;
+  } //if
+
+  const UINT64 nMask = m_nCapacity - 1; //for wrapping around
+  UINT64 i = (nKey*0x9E3779B97F4A7C15ULL) >> m_nShift; //home slot
+
+  while(m_nKey[i] != ~0ULL){ //linear probing
+    if(m_nKey[i] == nKey)return; //already there
+    i = (i + 1) & nMask;
+  } //while
+
+  m_nKey[i] = nKey;
+  m_nInput[i] = nInput;
+
+  if(2*++m_nCount > m_nCapacity) //too full
+    Grow();
+} //Insert
+
+/// Get the number of keys.
+/// \return Number of keys.
+
+const UINT64 CVectorSet::GetCount() const{
+  return m_nCount;
+} //GetCount
+
+/// Get the number of slots, for iterating through the keys with `GetSlot()`.
+/// \return Number of slots.
+
+const UINT64 CVectorSet::GetCapacity() const{
+  return m_nCapacity;
+} //GetCapacity
+
+/// Get the number of bytes used by the key and input arrays.
+/// \return Memory used in bytes.
+
+const UINT64 CVectorSet::GetBytes() const{
+  return 2*m_nCapacity*sizeof(UINT64);
+} //GetBytes
+
+/// Get the key in a slot and its input.
+/// \param i Slot index.
+/// \param nInput [OUT] Input attached to the key, if there is one.
+/// \return Key, or all ones if the slot is empty.
+
+const UINT64 CVectorSet::GetSlot(const UINT64 i, UINT64& nInput) const{
+  nInput = m_nInput[i];
+  return m_nKey[i];
+} //GetSlot
+
+/// Get whether the all-ones vector is in the set, which `GetSlot()`
+/// doesn't report.
+/// \param nInput [OUT] Input attached to the all-ones vector, if it is there.
+/// \return true if the all-ones vector is in the set.
+
+bool CVectorSet::GetOnes(UINT64& nInput) const{
+  nInput = m_nOnesInput;
+  return m_bOnes;
+} //GetOnes
+
+/// Find a vector in the set that isn't sorted, that is, one with a one on
+/// some channel and a zero on the next one, and get the input attached to
+/// it. The all-ones vector is sorted, so there is no need to check it.
+/// \param nInputs Number of channels.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted vector was found.
+
+bool CVectorSet::GetUnsorted(const UINT nInputs, std::vector<UINT>& vInput) const{
+  const UINT64 nLast = (nInputs < 2)? 0: ~0ULL >> (65 - nInputs); //all but last channel
+
+  for(UINT64 s=0; s<m_nCapacity; s++){ //for each slot
+    const UINT64 v = m_nKey[s];
+
+    if(v != ~0ULL && (v & ~(v >> 1) & nLast)){ //unsorted
+      vInput.resize(nInputs);
+
+      for(UINT j=0; j<nInputs; j++)
+        vInput[j] = (UINT)(m_nInput[s] >> j) & 1;
+
+      return true;
+    } //if
+  } //for
+
+  return false;
+} //GetUnsorted
+
+/// Get whether an allocation has failed since the last successful call to
+/// `Clear()`, in which case some keys may be missing.
+/// \return true if an allocation has failed.
+
+const bool CVectorSet::IsFailed() const{
+  return m_bFailed;
+} //IsFailed
+
+#pragma endregion CVectorSet
+
+///////////////////////////////////////////////////////////////////////////////
+// CReachableSetVerifier
+
+#pragma region CReachableSetVerifier
+
+/// Copy the comparators at each level and mark them as not having swapped.
+/// \param nInputs Number of inputs, at most 64.
+/// \param vecLevel Array of `std::vector`s of min-max `CComparator`s.
+/// \param nDepth Number of entries in `vecLevel`.
+
+CReachableSetVerifier::CReachableSetVerifier(const UINT nInputs,
+  std::vector<CComparator>* vecLevel, const UINT nDepth):
+  m_nInputs(nInputs), m_nDepth(nDepth)
+{
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    m_vecLevel.push_back(vecLevel[i]);
+    m_vecSwapped.push_back(std::vector<bool>(vecLevel[i].size(), false));
+  } //for
+} //constructor
+
+/// Generate the set of vectors after the first level, which is the set of
+/// vectors in which the channels of each comparator on the first level are
+/// 00, 01, or 11 (min channel first) and the other channels are 0 or 1. Every
+/// comparator on the first level swaps on the input 10, so they are all marked
+/// as swapped. Each vector is its own input since the first level doesn't
+/// change it. The first level has no duplicates, so instead of storing its
+/// set we can push each vector straight through the second level and store
+/// the result.
+/// \param set [OUT] Set to generate into.
+/// \param bSecond true to push the vectors through the second level too.
+
+void CReachableSetVerifier::FirstLevel(CVectorSet& set, const bool bSecond){
+  std::vector<UINT64> nMask; //bits that each digit changes
+  std::vector<UINT> nRadix; //number of values of each digit
+  std::vector<bool> bCovered(m_nInputs, false); //whether channel is in a comparator
+
+  if(m_nDepth > 0)
+    for(UINT c=0; c<m_vecLevel[0].size(); c++){ //for each comparator on first level
+      const CComparator& p = m_vecLevel[0][c];
+      nMask.push_back(1ULL << p.m_nMax); //01
+      nMask.push_back(1ULL << p.m_nMin); //11
+      nRadix.push_back(3);
+      bCovered[p.m_nMin] = bCovered[p.m_nMax] = true;
+      m_vecSwapped[0][c] = true;
+    } //for
+
+  for(UINT j=0; j<m_nInputs; j++) //for each channel
+    if(!bCovered[j]){ //not in a comparator
+      nMask.push_back(1ULL << j);
+      nMask.push_back(0); //unused
+      nRadix.push_back(2);
+    } //if
+
+  set.Clear(bSecond? 0: GetFirstCount()); //if there's a second level, let it grow
+
+  std::vector<UINT> nDigit(nRadix.size(), 0); //mixed radix odometer
+  UINT64 v = 0; //current vector
+  bool bMore = true; //whether there are more vectors
+
+  while(bMore){
+    set.Insert(bSecond? PushLevel(1, v): v, v);
+    bMore = false;
+
+    for(UINT u=0; u<nRadix.size() && !bMore; u++){ //increment odometer
+      if(++nDigit[u] < nRadix[u]){ //no carry
+        v |= nMask[2*u + nDigit[u] - 1]; //set the next bit
+        bMore = true;
+      } //if
+
+      else{ //carry
+        v &= ~(nMask[2*u] | nMask[2*u + 1]); //back to zero
+        nDigit[u] = 0;
+      } //else
+    } //for
+  } //while
+} //FirstLevel
+
+/// Push a vector through the comparators on a level, and mark the ones that
+/// swap.
+/// \param i Level.
+/// \param v Vector.
+/// \return The vector after level i.
+
+UINT64 CReachableSetVerifier::PushLevel(const UINT i, UINT64 v){
+  const std::vector<CComparator>& vecLevel = m_vecLevel[i]; //comparators
+  std::vector<bool>& vecSwapped = m_vecSwapped[i]; //whether they swap
+
+  for(UINT c=0; c<vecLevel.size(); c++){ //for each comparator
+    const UINT64 j = 1ULL << vecLevel[c].m_nMin; //min channel bit
+    const UINT64 k = 1ULL << vecLevel[c].m_nMax; //max channel bit
+
+    if((v & j) && !(v & k)){ //swap
+      v ^= j | k;
+      vecSwapped[c] = true;
+    } //if
+  } //for
+
+  return v;
+} //PushLevel
+
+/// Generate the set of vectors after a level from the set after the previous
+/// level by pushing each vector through the comparators on that level.
+/// \param i Level, greater than zero.
+/// \param set Set after the previous level.
+/// \param next [OUT] Set to generate into.
+
+void CReachableSetVerifier::NextLevel(const UINT i, const CVectorSet& set,
+  CVectorSet& next)
+{
+  next.Clear(set.GetCount());
+
+  UINT64 nInput = 0; //input attached to vector
+  
+  for(UINT64 s=0; s<set.GetCapacity(); s++){ //for each slot
+    const UINT64 v = set.GetSlot(s, nInput); //vector in that slot
+
+    if(v != ~0ULL) //not empty
+      next.Insert(PushLevel(i, v), nInput);
+  } //for
+
+  if(set.GetOnes(nInput)) //all ones
+    next.Insert(PushLevel(i, ~0ULL), nInput);
+} //NextLevel
+
+/// Get the comparators on a level.
+/// \param i Level.
+/// \return Comparators on level i.
+
+const std::vector<CComparator>& CReachableSetVerifier::GetLevel(const UINT i) const{
+  return m_vecLevel[i];
+} //GetLevel
+
+/// Replace the comparators on a level and mark them as not having swapped.
+/// The sets after that level and every later one must then be generated
+/// again before `GetUsage()` is called.
+/// \param i Level.
+/// \param vecLevel Min-max `CComparator`s for level i.
+
+void CReachableSetVerifier::SetLevel(const UINT i,
+  const std::vector<CComparator>& vecLevel)
+{
+  m_vecLevel[i] = vecLevel;
+  m_vecSwapped[i].assign(vecLevel.size(), false);
+} //SetLevel
+
+/// Check whether the comparator network sorts all zero-one inputs by
+/// computing the set of vectors after each level in turn, then looking for
+/// an unsorted vector in the final set. Assumes that `IsReady()` is true.
+/// \return true if it sorts, false if it doesn't or if memory ran out.
+
+bool CReachableSetVerifier::Verify(){
+  m_vFailed.clear();
+  m_bSorts = false;
+
+  Begin();
+  while(Step()); //all the remaining levels
+  if(OutOfMemory())return false; //bail and fail
+
+  m_bSorts = !m_cSet[m_nCurrent].GetUnsorted(m_nInputs, m_vFailed);
+  return m_bSorts;
+} //Verify
+
+/// Mark the channels at the ends of every comparator that swapped its
+/// inputs during `Verify()` as used. Other entries are left unchanged.
+/// \param bUsed [IN, OUT] Usage array indexed by level then channel.
+
+void CReachableSetVerifier::GetUsage(CBitArray& bUsed) const{
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(UINT c=0; c<m_vecLevel[i].size(); c++) //for each comparator
+      if(m_vecSwapped[i][c]){
+        const CComparator& p = m_vecLevel[i][c];
+        bUsed.Set(i, p.m_nMin); //mark both channels used
+        bUsed.Set(i, p.m_nMax);
+      } //if
+} //GetUsage
+
+/// Get an input that isn't sorted, if there is one. The verifier only
+/// remembers one input for each vector in the set, so this is whichever
+/// input first reached an unsorted vector after the last level.
+/// \param vInput [OUT] Zero-one input, one entry per channel.
+/// \return true if an unsorted input was found.
+
+bool CReachableSetVerifier::GetCounterexample(std::vector<UINT>& vInput) const{
+  if(m_vFailed.empty())return false; //bail and fail
+  vInput = m_vFailed;
+  return true;
+} //GetCounterexample
+
+/// Get the number of distinct vectors after each level. The largest of these
+/// determines how much memory `Verify()` needs.
+/// \return Set size after each level.
+
+const std::vector<UINT64>& CReachableSetVerifier::GetSetSizes() const{
+  return m_vSetSize;
+} //GetSetSizes
+
+/// Start over by generating the set of vectors after the first level, and
+/// optionally the second level too if there is one.
+/// \param bSecond true to include the second level, which is faster.
+
+void CReachableSetVerifier::Begin(const bool bSecond){
+  m_vSetSize.clear();
+  m_nCurrent = 0;
+  m_nLevels = (bSecond && m_nDepth > 1)? 2: 1;
+
+  FirstLevel(m_cSet[m_nCurrent], m_nLevels == 2);
+
+  m_vSetSize.push_back(GetFirstCount());
+  if(m_nLevels == 2)m_vSetSize.push_back(GetSet().GetCount());
+} //Begin
+
+/// Generate the set of vectors after the next level from the current set.
+/// This must be preceded by a call to `Begin()`.
+/// \return false if there are no more levels or memory has run out.
+
+bool CReachableSetVerifier::Step(){
+  if(m_nLevels >= m_nDepth || OutOfMemory())return false; //bail out
+
+  NextLevel(m_nLevels++, m_cSet[m_nCurrent], m_cSet[m_nCurrent ^ 1]);
+  m_nCurrent ^= 1;
+  m_vSetSize.push_back(GetSet().GetCount());
+
+  return true;
+} //Step
+
+/// Get the number of levels that the current set is after.
+/// \return Number of levels.
+
+const UINT CReachableSetVerifier::GetLevels() const{
+  return m_nLevels;
+} //GetLevels
+
+/// Get the current set, which is the set of vectors after the first
+/// `GetLevels()` levels.
+/// \return The current set.
+
+const CVectorSet& CReachableSetVerifier::GetSet() const{
+  return m_cSet[m_nCurrent];
+} //GetSet
+
+/// Get the number of distinct vectors after the first level without
+/// generating them. A comparator on the first level allows 3 values on
+/// its channels, and every other channel allows 2.
+/// \return Number of vectors after the first level, or all ones if that
+/// doesn't fit into 64 bits.
+
+const UINT64 CReachableSetVerifier::GetFirstCount() const{
+  const UINT nPairs = (m_nDepth > 0)? (UINT)m_vecLevel[0].size(): 0; //comparators
+  const UINT nSingles = m_nInputs - 2*nPairs; //channels not in a comparator
+  
+  UINT64 nCount = 1; //the count
+
+  for(UINT i=0; i<nPairs; i++){
+    if(nCount > ~0ULL/3)return ~0ULL; //too many
+    nCount *= 3;
+  } //for
+  
+  for(UINT i=0; i<nSingles; i++){
+    if(nCount > ~0ULL/2)return ~0ULL; //too many
+    nCount *= 2;
+  } //for
+
+  return nCount;
+} //GetFirstCount
+
+/// Whether the set of vectors after the first level is small enough to be
+/// stored, which bounds the size of all later sets.
+/// \return true if `Verify()` can be called.
+
+bool CReachableSetVerifier::IsReady() const{
+  return m_nInputs <= 64 && GetFirstCount() <= MAXFIRSTCOUNT;
+} //IsReady
+
+/// Whether memory ran out while computing the current set, in which case
+/// it is incomplete.
+/// \return true if memory ran out.
+
+const bool CReachableSetVerifier::OutOfMemory() const{
+  return m_cSet[m_nCurrent].IsFailed();
+} //OutOfMemory
+
+#pragma endregion CReachableSetVerifier
@@ -0,0 +1,135 @@
+/// \file ReachableSetVerifier.h
+/// \brief Interface for the reachable set verifier CReachableSetVerifier.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __ReachableSetVerifier_h__
+#define __ReachableSetVerifier_h__
+
+#include "Platform.h"
+#include "ComparatorNetwork.h"
+
+/// \brief Set of zero-one vectors.
+///
+/// `CVectorSet` is an open-addressed hash table with linear probing whose keys
+/// are zero-one vectors of up to 64 bits packed into a `UINT64`, with bit
+/// \f$j\f$ holding the value on channel \f$j\f$. Each key has a zero-one input
+/// attached to it, which for `CReachableSetVerifier` is an input that the
+/// comparator network maps to that vector. The all-ones key is used to
+/// mark empty slots, so the all-ones vector is kept separately. If the
+/// arrays can't be allocated the set is marked as failed, and keys inserted
+/// after that are lost, so the caller must check `IsFailed()`.
+
+class CVectorSet{
+  private:
+    UINT64* m_nKey = nullptr; ///< Keys, all ones for an empty slot.
+    UINT64* m_nInput = nullptr; ///< Input attached to each key.
+    UINT64 m_nCapacity = 0; ///< Number of slots, a power of 2.
+    UINT m_nShift = 64; ///< Shift for the hash function, 64 minus log capacity.
+    UINT64 m_nCount = 0; ///< Number of keys.
+
+    bool m_bOnes = false; ///< Whether the all-ones vector is in the set.
+    UINT64 m_nOnesInput = 0; ///< Input attached to the all-ones vector.
+    bool m_bFailed = false; ///< Whether an allocation has failed.
+
+    void Grow(); ///< Double the capacity.
+
+  public:
+    ~CVectorSet(); ///< Destructor.
+
+    void Clear(const UINT64); ///< Make empty with room for some keys.
+    void Free(); ///< Make empty and release the memory.
+    void Insert(const UINT64, const UINT64); ///< Insert a key and its input.
+
+    const UINT64 GetCount() const; ///< Get number of keys.
+    const UINT64 GetCapacity() const; ///< Get number of slots.
+    const UINT64 GetBytes() const; ///< Get memory used.
+    const UINT64 GetSlot(const UINT64, UINT64&) const; ///< Get key in slot.
+    bool GetOnes(UINT64&) const; ///< Whether all-ones vector is in set.
+    bool GetUnsorted(const UINT, std::vector<UINT>&) const; ///< Find unsorted vector.
+    const bool IsFailed() const; ///< Whether an allocation has failed.
+}; //CVectorSet
+
+/// \brief Reachable set verifier.
+///
+/// `CReachableSetVerifier` tests whether a comparator network is a sorting
+/// network using the _Zero-One Principle_ by computing the set of distinct
+/// zero-one vectors that can appear on the channels after each level, starting
+/// with the set of all zero-one inputs. A comparator network sorts iff only the
+/// \f$n + 1\f$ sorted vectors remain after the last level. The set after the
+/// first level is generated directly rather than by pushing all \f$2^n\f$ inputs
+/// through it, and each later one is computed by pushing the members of the
+/// previous one through the comparators on that level. This is much faster than
+/// enumerating all inputs when the early levels of the comparator network
+/// collapse the set quickly, but it needs memory proportional to the size
+/// of the largest set, so the size of the set after each level is recorded.
+/// This only works for comparator networks with at most 64 inputs. The sets
+/// can also be computed one level at a time with `Begin()` and `Step()`,
+/// which is how `CPrefixVerifier` gets the set after the first few levels,
+/// or into sets supplied by the caller with `FirstLevel()` and `NextLevel()`,
+/// which is how `CIncrementalVerifier` keeps the set after every level.
+/// No set is larger than the one after the first level, whose size
+/// `GetFirstCount()` gives without generating it, so `IsReady()` refuses
+/// comparator networks for which that is too large. If memory runs out
+/// anyway, `OutOfMemory()` says so and `Verify()` gives up.
+
+class CReachableSetVerifier{
+  private:
+    UINT m_nInputs = 0; ///< Number of inputs.
+    UINT m_nDepth = 0; ///< Depth.
+    std::vector<std::vector<CComparator>> m_vecLevel; ///< Comparators at each level.
+    std::vector<std::vector<bool>> m_vecSwapped; ///< Whether each comparator swaps.
+
+    CVectorSet m_cSet[2]; ///< Current and next sets.
+    UINT m_nCurrent = 0; ///< Index of current set.
+    UINT m_nLevels = 0; ///< Number of levels the current set is after.
+    std::vector<UINT64> m_vSetSize; ///< Size of set after each level.
+
+    bool m_bSorts = false; ///< Whether it sorts.
+    std::vector<UINT> m_vFailed; ///< Input that isn't sorted, if any.
+
+    UINT64 PushLevel(const UINT, UINT64); ///< Push vector through a level.
+
+  public:
+    CReachableSetVerifier(const UINT, std::vector<CComparator>*, const UINT); ///< Constructor.
+
+    bool Verify(); ///< Does it sort?
+    void GetUsage(CBitArray&) const; ///< Get comparator usage.
+    bool GetCounterexample(std::vector<UINT>&) const; ///< Get unsorted input.
+    const std::vector<UINT64>& GetSetSizes() const; ///< Get set sizes.
+
+    void Begin(const bool=true); ///< Generate set after the first one or two levels.
+    bool Step(); ///< Generate set after the next level.
+    const UINT GetLevels() const; ///< Get number of levels done.
+    const CVectorSet& GetSet() const; ///< Get current set.
+    const UINT64 GetFirstCount() const; ///< Get size of set after first level.
+    bool IsReady() const; ///< Whether the sets will fit into memory.
+    const bool OutOfMemory() const; ///< Whether memory ran out.
+
+    void FirstLevel(CVectorSet&, const bool=false); ///< Generate set after the first one or two levels.
+    void NextLevel(const UINT, const CVectorSet&, CVectorSet&); ///< Generate set after a later level.
+    const std::vector<CComparator>& GetLevel(const UINT) const; ///< Get comparators on a level.
+    void SetLevel(const UINT, const std::vector<CComparator>&); ///< Replace comparators on a level.
+}; //CReachableSetVerifier
+
+#endif //__ReachableSetVerifier_h__
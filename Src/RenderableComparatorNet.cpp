@@ -24,50 +24,138 @@
 // SOFTWARE.
 
 
-#include "Includes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
 #include "RenderableComparatorNet.h"
-#include "WindowsHelpers.h"
+#include "Helpers.h"
+#include "PngWriter.h"
+
+#ifdef _WIN32
+  #include "WindowsHelpers.h"
+#endif
+
+/// Copy constructor. The bitmap isn't copied, so the copy must be drawn
+/// again before it has one.
+/// \param c Comparator network to copy.
+
+CRenderableComparatorNet::CRenderableComparatorNet(
+  const CRenderableComparatorNet& c):
+  CComparatorNetwork(c), m_eDrawStyle(c.m_eDrawStyle),
+  m_eExportType(c.m_eExportType)
+{
+} //copy constructor
+
+/// Move constructor, which takes the bitmap.
+/// \param c Comparator network to move.
+
+CRenderableComparatorNet::CRenderableComparatorNet(
+  CRenderableComparatorNet&& c) noexcept:
+  CComparatorNetwork(std::move(c)), m_eDrawStyle(c.m_eDrawStyle),
+  m_eExportType(c.m_eExportType)
+{
+#ifdef _WIN32
+  std::swap(m_pBitmap, c.m_pBitmap);
+#endif
+} //move constructor
 
 ///< Delete the bitmap.
 
 CRenderableComparatorNet::~CRenderableComparatorNet(){
+#ifdef _WIN32
   delete m_pBitmap;
+#endif
 } //destructor
 
+/// Copy assignment. The bitmap isn't copied, and any old one is deleted,
+/// so this must be drawn again before it has one. The cached layouts are
+/// discarded since they belong to the old comparator network.
+/// \param c Comparator network to copy.
+/// \return This comparator network.
+
+CRenderableComparatorNet& CRenderableComparatorNet::operator=(
+  const CRenderableComparatorNet& c)
+{
+  if(this != &c){
+    CComparatorNetwork::operator=(c);
+    m_eDrawStyle = c.m_eDrawStyle;
+    m_eExportType = c.m_eExportType;
+    m_cLayout[0].Invalidate();
+    m_cLayout[1].Invalidate();
+
+#ifdef _WIN32
+    delete m_pBitmap;
+    m_pBitmap = nullptr;
+#endif
+  } //if
+
+  return *this;
+} //operator=
+
+/// Move assignment, which swaps bitmaps so that the old one gets deleted
+/// along with the other comparator network. The cached layouts are
+/// discarded since they belong to the old comparator network.
+/// \param c Comparator network to move.
+/// \return This comparator network.
+
+CRenderableComparatorNet& CRenderableComparatorNet::operator=(
+  CRenderableComparatorNet&& c) noexcept
+{
+  if(this != &c){
+    CComparatorNetwork::operator=(std::move(c));
+    m_eDrawStyle = c.m_eDrawStyle;
+    m_eExportType = c.m_eExportType;
+    m_cLayout[0].Invalidate();
+    m_cLayout[1].Invalidate();
+
+#ifdef _WIN32
+    std::swap(m_pBitmap, c.m_pBitmap);
+#endif
+  } //if
+
+  return *this;
+} //operator=
+
+/// Get the layout of the comparator network in a draw style, building it
+/// only if the comparator network has changed since it was last built.
+/// Switching draw styles and exporting the same comparator network more
+/// than once therefore skip the layout entirely.
+/// \param eStyle Draw style.
+/// \return Layout in draw style `eStyle`.
+
+const CComparatorLayout& CRenderableComparatorNet::GetLayout(
+  const eDrawStyle eStyle)
+{
+  CComparatorLayout& cLayout = m_cLayout[eStyle == eDrawStyle::Vertical? 1: 0];
+
+  if(!cLayout.IsCurrent(*this))
+    cLayout.Build(*this, eStyle);
+
+  return cLayout;
+} //GetLayout
+
 /// Compute the bitmap height when drawn in vertical draw mode. Note that this
 /// does not actually draw the comparator network to a bitmap, but it goes
 /// through the motions and tallies up the height that would be used.
+/// The number of passes at each level is the same in both draw styles,
+/// since putting comparators in scan order into the first pass that they
+/// fit into makes as many passes as the largest number of comparators that
+/// overlap one another, whichever way the channels are scanned. The layout
+/// for the current draw style is used so that only one has to be built.
 /// \return Bitmap height in pixels.
 
-Gdiplus::REAL CRenderableComparatorNet::ComputeBitmapHeight(){
-  bool* bUsed = new bool[m_nInputs]; //whether channels are used at the current level
-  Gdiplus::REAL fHeight = m_fYDelta + m_fYDelta2; //height of comparator network so far
-
-  for(UINT i=0; i<m_nDepth; i++){
-    for(UINT j=0; j<m_nInputs; j++) //mark all channels unused
-      bUsed[j] = false;
-
-    //make a pass through the current level printing non-overlapping comparators
-    
-    for(UINT pass=0; pass<m_nInputs/2; pass++){
-      bool bPassUsed = false; //whether unprinted comparator found in this level
-      
-      for(UINT j=0; j<m_nInputs; j++){ //for rach channel
-        const UINT dest = m_nMatch[i][j]; //other end of comparator
-
-        if(dest < m_nInputs && dest > j && !bUsed[j]){ //can print without overlap
-          bPassUsed = bUsed[j] = bUsed[dest] = true; //mark that we've printed it
-          j = dest; //so that later comparators can't overlap
-        } //if
-      } //for
-
-      if(bPassUsed)fHeight += m_fYDelta; //current pass found a comparator
-    } //for
+float CRenderableComparatorNet::ComputeBitmapHeight(){
+  const CComparatorLayout& cLayout = GetLayout(m_eDrawStyle);
+  float fHeight = m_fYDelta + m_fYDelta2; //height of comparator network so far
 
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    fHeight += cLayout.GetPasses(i)*m_fYDelta; //one row per pass
     fHeight += m_fYDelta2; //next level
   } //for
 
-  delete [] bUsed;
   return fHeight;
 } //ComputeBitmapHeight
 
@@ -76,7 +164,7 @@ Gdiplus::REAL CRenderableComparatorNet::ComputeBitmapHeight(){
 /// to the bitmap pointed to by `m_pBitmap` via the graphics object
 /// pointed to by `m_pGraphics`. Otherwise we output the vector graphics
 /// commands to draw the comparator (a line and two filled circles) to the file
-/// pointed to by `m_pOutput`.
+/// written by `m_cOutput`.
 /// \param src Source (min) channel.
 /// \param dest Destination (max) channel.
 /// \param fDist Distance along channel to comparator in pixels.
@@ -87,7 +175,6 @@ void CRenderableComparatorNet::DrawComparator(
 {
   float fSrcy = 0, fDesty = 0, fSrcx = 0, fDestx = 0; //end points for PNG, SVG 
   int vx = 0, vy = 0; //axis for TeX
-  const float r = m_fDiameter/2.0f; //circle radius for connectors
 
   switch(m_eDrawStyle){
     case eDrawStyle::Vertical:
@@ -113,9 +200,11 @@ void CRenderableComparatorNet::DrawComparator(
 
   switch(m_eExportType){
     case eExport::Png: 
+#ifdef _WIN32
       if(bRed){
         if(m_pGraphics && m_pRedPen && m_pRedBrush){
           const float d = m_fDiameter; //shorthand for diameter
+          const float r = d/2.0f; //circle radius for connectors
 
           m_pGraphics->FillEllipse(m_pRedBrush,  fSrcx - r,  fSrcy - r, d, d);
           m_pGraphics->FillEllipse(m_pRedBrush, fDestx - r, fDesty - r, d, d);
@@ -126,40 +215,51 @@ void CRenderableComparatorNet::DrawComparator(
       else{
         if(m_pGraphics && m_pPen && m_pBrush){
           const float d = m_fDiameter; //shorthand for diameter
+          const float r = d/2.0f; //circle radius for connectors
 
           m_pGraphics->FillEllipse(m_pBrush,  fSrcx - r,  fSrcy - r, d, d);
           m_pGraphics->FillEllipse(m_pBrush, fDestx - r, fDesty - r, d, d);
           m_pGraphics->DrawLine(m_pPen, fSrcx, fSrcy, fDestx, fDesty);
         } //if
       } //else
+#endif
     break;
 
     case eExport::Svg:
-      if(m_pOutput){
-        fprintf_s(m_pOutput, "<circle ");
-        if(bRed)fprintf_s(m_pOutput, "style=\"fill:red\" ");
-        fprintf_s(m_pOutput, "cx=\"%d\" cy=\"%d\"/>", nSrcx,  nSrcy);
-
-        fprintf_s(m_pOutput, "<circle ");
-        if(bRed)fprintf_s(m_pOutput, "style=\"fill:red\" ");
-        fprintf_s(m_pOutput, "cx=\"%d\" cy=\"%d\"/>", nDestx, nDesty); 
-
-        fprintf_s(m_pOutput, "<line ");
-        if(bRed)fprintf_s(m_pOutput, "style=\"stroke:red\" ");
-        fprintf_s(m_pOutput, "x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\"/>\n",
-          nSrcx, nSrcy, nDestx, nDesty);
+      if(m_cOutput.IsOpen()){
+        CTextWriter& w = m_cOutput; //shorthand
+
+        w.Put("<circle ");
+        if(bRed)w.Put("style=\"fill:red\" ");
+        w.Put("cx=\""); w.Put(nSrcx); w.Put("\" cy=\""); w.Put(nSrcy); w.Put("\"/>");
+
+        w.Put("<circle ");
+        if(bRed)w.Put("style=\"fill:red\" ");
+        w.Put("cx=\""); w.Put(nDestx); w.Put("\" cy=\""); w.Put(nDesty); w.Put("\"/>");
+
+        w.Put("<line ");
+        if(bRed)w.Put("style=\"stroke:red\" ");
+        w.Put("x1=\""); w.Put(nSrcx); w.Put("\" y1=\""); w.Put(nSrcy);
+        w.Put("\" x2=\""); w.Put(nDestx); w.Put("\" y2=\""); w.Put(nDesty);
+        w.Put("\"/>\n");
       } //if
     break;
 
     case eExport::TeX: 
-      if(m_pOutput){
+      if(m_cOutput.IsOpen()){
+        CTextWriter& w = m_cOutput; //shorthand
         const int d = (UINT)std::round(m_fDiameter);
         const UINT nLen = abs(nDestx - nSrcx + nDesty - nSrcy);
 
-        fprintf_s(m_pOutput, "\\put(%d,-%d){\\circle*{%d}}\n", nSrcx, nSrcy, d);
-        fprintf_s(m_pOutput, "\\put(%d,-%d){\\circle*{%d}}\n", nDestx, nDesty, d); 
-        fprintf_s(m_pOutput, "\\put(%d,-%d){\\line(%d,%d){%u}}\n", nDestx, nDesty,
-          vx, vy, nLen); 
+        w.Put("\\put("); w.Put(nSrcx); w.Put(",-"); w.Put(nSrcy);
+        w.Put("){\\circle*{"); w.Put(d); w.Put("}}\n");
+
+        w.Put("\\put("); w.Put(nDestx); w.Put(",-"); w.Put(nDesty);
+        w.Put("){\\circle*{"); w.Put(d); w.Put("}}\n");
+
+        w.Put("\\put("); w.Put(nDestx); w.Put(",-"); w.Put(nDesty);
+        w.Put("){\\line("); w.Put(vx); w.Put(','); w.Put(vy);
+        w.Put("){"); w.Put(nLen); w.Put("}}\n");
       } //if
     break;
   } //switch
@@ -171,56 +271,29 @@ void CRenderableComparatorNet::DrawComparator(
 /// to the bitmap pointed to by `m_pBitmap` via the graphics object
 /// pointed to by `m_pGraphics`. Otherwise we output the vector graphics
 /// commands to draw the comparators (lines and filled circles) to the file
-/// pointed to by `m_pOutput`.
+/// written by `m_cOutput`.
 
 void CRenderableComparatorNet::DrawComparators(){
-  bool* bUsed = new bool[m_nInputs]; //whether channels are used at the current level
+  const CComparatorLayout& cLayout = GetLayout(m_eDrawStyle);
   float fLen = m_fYDelta + m_fYDelta2; //distance along channel
 
   for(UINT i=0; i<m_nDepth; i++){ //for each level
-    for(UINT j=0; j<m_nInputs; j++) //mark all channels unused
-      bUsed[j] = false;
+    const UINT nPasses = cLayout.GetPasses(i); //number of passes at this level
 
-    //make a pass through the current level printing comparators that don't overlap
-    
-    for(UINT pass=0; pass<m_nInputs/2; pass++){
-      bool bPassUsed = false; //whether we found an unprinted comparator in this level
-      
-      switch(m_eDrawStyle){
-        case eDrawStyle::Vertical:
-          for(UINT j=0; j<m_nInputs; j++){
-            const UINT dest = m_nMatch[i][j];
-
-            if(dest < m_nInputs && dest > j && !bUsed[j]){ //can print without overlap
-              const bool bRed = m_bSorts && !m_bUsed[i][j]; //whether to be drawn red
-              DrawComparator(dest, j, fLen, bRed); //draw comparator
-              bPassUsed = bUsed[j] = bUsed[dest] = true; //mark that we've printed it
-              j = dest; //so that later comparators can't overlap
-            } //if
-          } //for
-          break;
+    for(UINT pass=0; pass<nPasses; pass++){ //for each pass
+      UINT n = 0; //number of comparators in this pass
+      const CComparator* pPass = cLayout.GetPass(i, pass, n);
 
-        case eDrawStyle::Horizontal:
-          for(int j=m_nInputs-1; j>=0; j--){
-            const UINT dest = m_nMatch[i][j]; 
-
-            if(dest < m_nInputs && dest < (UINT)j && !bUsed[dest]){ //can print without overlap
-              const bool bRed = m_bSorts && !m_bUsed[i][j]; //whether to be drawn red
-              DrawComparator(j, dest, fLen, bRed); //draw comparator
-              bPassUsed = bUsed[j] = bUsed[dest] = true; //mark that we've printed it
-              j = dest; //so that later comparators can't overlap
-            } //if
-          } //for
-          break;
-      } //switch
+      for(UINT c=0; c<n; c++){ //for each comparator in scan order
+        const CComparator& p = pPass[c]; //the comparator
+        DrawComparator(p.m_nMax, p.m_nMin, fLen, IsRed(i, p)); //draw comparator
+      } //for
 
-      if(bPassUsed)fLen += m_fYDelta; //the current pass found a comparator
+      fLen += m_fYDelta; //next pass
     } //for
 
     fLen += m_fYDelta2; //next level
   } //for
-
-  delete [] bUsed;
 } //DrawComparators
 
 /// Draw channels. The behaviour of this function depends on the value of
@@ -228,7 +301,7 @@ void CRenderableComparatorNet::DrawComparators(){
 /// to the bitmap pointed to by `m_pBitmap` via the graphics object
 /// pointed to by `m_pGraphics`. Otherwise we output the vector graphics
 /// commands to draw the channels (a line for each channel) to the file
-/// pointed to by `m_pOutput`.
+/// written by `m_cOutput`.
 /// \param fLen Length of channels in pixels.
 
 void CRenderableComparatorNet::DrawChannels(const float fLen){
@@ -260,20 +333,30 @@ void CRenderableComparatorNet::DrawChannels(const float fLen){
 
     switch(m_eExportType){
       case eExport::Png:
+#ifdef _WIN32
         if(m_pGraphics) //safety
           m_pGraphics->DrawLine(m_pPen, fSrcx, fSrcy, fDestx, fDesty);
+#endif
         break;
 
       case eExport::Svg:
-        if(m_pOutput) //safety
-          fprintf_s(m_pOutput, "<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\"/>\n",
-            nSrcx, nSrcy, nDestx, nDesty);
+        if(m_cOutput.IsOpen()){ //safety
+          CTextWriter& w = m_cOutput; //shorthand
+
+          w.Put("<line x1=\""); w.Put(nSrcx); w.Put("\" y1=\""); w.Put(nSrcy);
+          w.Put("\" x2=\""); w.Put(nDestx); w.Put("\" y2=\""); w.Put(nDesty);
+          w.Put("\"/>\n");
+        } //if
         break;
 
       case eExport::TeX: 
-        if(m_pOutput) //safety
-          fprintf_s(m_pOutput, "\\put(%d,-%d){\\line(%d,%d){%d}}\n",
-            nSrcx, nSrcy, vx, vy, nLen); 
+        if(m_cOutput.IsOpen()){ //safety
+          CTextWriter& w = m_cOutput; //shorthand
+
+          w.Put("\\put("); w.Put(nSrcx); w.Put(",-"); w.Put(nSrcy);
+          w.Put("){\\line("); w.Put(vx); w.Put(','); w.Put(vy);
+          w.Put("){"); w.Put(nLen); w.Put("}}\n");
+        } //if
       break;
     } //switch
 
@@ -284,6 +367,213 @@ void CRenderableComparatorNet::DrawChannels(const float fLen){
   } //for
 } //DrawChannels
 
+/// Test whether a comparator is to be drawn red, which it is if the
+/// comparator network is known to sort and the comparator is never used.
+/// \param i Level.
+/// \param p Comparator at level `i`.
+/// \return True if it is to be drawn red.
+
+const bool CRenderableComparatorNet::IsRed(
+  const UINT i, const CComparator& p) const
+{
+  return m_bSorts && !m_bUsed(i, p.m_nMin);
+} //IsRed
+
+/// Hash the drawing of a level, that is, the number of passes and the
+/// channels and color of the comparators in each pass, but not where the
+/// level starts along the channels.
+/// \param cLayout Layout in the current draw style.
+/// \param i Level.
+/// \return 64-bit FNV-1a hash.
+
+const UINT64 CRenderableComparatorNet::HashLevel(
+  const CComparatorLayout& cLayout, const UINT i) const
+{
+  const UINT nPasses = cLayout.GetPasses(i); //number of passes at this level
+  UINT64 h = Fnv1a(&nPasses, sizeof(UINT));
+
+  for(UINT pass=0; pass<nPasses; pass++){ //for each pass
+    UINT n = 0; //number of comparators in this pass
+    const CComparator* pPass = cLayout.GetPass(i, pass, n);
+    h = Fnv1a(&n, sizeof(UINT), h);
+
+    for(UINT c=0; c<n; c++){ //for each comparator in scan order
+      const UINT v[3] = {pPass[c].m_nMin, pPass[c].m_nMax, IsRed(i, pPass[c])};
+      h = Fnv1a(v, sizeof(v), h);
+    } //for
+  } //for
+
+  return h;
+} //HashLevel
+
+/// Test whether two levels are drawn the same apart from where they start
+/// along the channels.
+/// \param cLayout Layout in the current draw style.
+/// \param i Level.
+/// \param j Level.
+/// \return True if levels `i` and `j` look the same.
+
+const bool CRenderableComparatorNet::SameLevel(
+  const CComparatorLayout& cLayout, const UINT i, const UINT j) const
+{
+  const UINT nPasses = cLayout.GetPasses(i); //number of passes at level i
+  if(cLayout.GetPasses(j) != nPasses)return false;
+
+  for(UINT pass=0; pass<nPasses; pass++){ //for each pass
+    UINT m = 0, n = 0; //number of comparators in this pass at each level
+    const CComparator* p = cLayout.GetPass(i, pass, m);
+    const CComparator* q = cLayout.GetPass(j, pass, n);
+    if(m != n)return false;
+
+    for(UINT c=0; c<n; c++) //for each comparator in scan order
+      if(p[c].m_nMin != q[c].m_nMin || p[c].m_nMax != q[c].m_nMax ||
+        IsRed(i, p[c]) != IsRed(j, q[c]))
+        return false;
+  } //for
+
+  return true;
+} //SameLevel
+
+/// Draw channels in compact SVG, which is a single path with one line for
+/// each channel.
+/// \param fLen Length of channels in pixels.
+
+void CRenderableComparatorNet::DrawCompactChannels(const float fLen){
+  CTextWriter& w = m_cOutput; //shorthand
+  const int nLen = (UINT)std::round(fLen);
+
+  w.Put("<path d=\"");
+
+  for(UINT i=0; i<m_nInputs; i++){ //for each channel
+    const int x = (UINT)std::round(m_fDiameter/2 + i*m_fXDelta); //across channels
+
+    switch(m_eDrawStyle){
+      case eDrawStyle::Vertical:
+        w.Put('M'); w.Put(x); w.Put(" 0V"); w.Put(nLen);
+        break;
+
+      case eDrawStyle::Horizontal:
+        w.Put("M0 "); w.Put(x); w.Put('H'); w.Put(nLen);
+        break;
+    } //switch
+  } //for
+
+  w.Put("\"/>\n");
+} //DrawCompactChannels
+
+/// Draw the comparators of one color at a level in compact SVG, as a path
+/// with a line for each comparator. The dots at the ends of the
+/// comparators are markers on every vertex of the path. Positions along the
+/// channels are relative to the start of the level. Nothing is drawn if
+/// there are no comparators of that color.
+/// \param cLayout Layout in the current draw style.
+/// \param i Level.
+/// \param bRed True to draw the red comparators, false for the black ones.
+
+void CRenderableComparatorNet::DrawCompactLevel(
+  const CComparatorLayout& cLayout, const UINT i, const bool bRed)
+{
+  CTextWriter& w = m_cOutput; //shorthand
+  const UINT nPasses = cLayout.GetPasses(i); //number of passes at this level
+  bool bStarted = false; //whether the path element has been started
+
+  for(UINT pass=0; pass<nPasses; pass++){ //for each pass
+    const int a = (UINT)std::round(pass*m_fYDelta); //along channels
+    UINT n = 0; //number of comparators in this pass
+    const CComparator* pPass = cLayout.GetPass(i, pass, n);
+
+    for(UINT c=0; c<n; c++){ //for each comparator in scan order
+      const CComparator& p = pPass[c]; //the comparator
+      if(IsRed(i, p) != bRed)continue; //other color
+
+      if(!bStarted){
+        w.Put(bRed? "<path class=\"r\" d=\"": "<path class=\"c\" d=\"");
+        bStarted = true;
+      } //if
+
+      const int nSrc  = (UINT)std::round(m_fDiameter/2 + p.m_nMax*m_fXDelta);
+      const int nDest = (UINT)std::round(m_fDiameter/2 + p.m_nMin*m_fXDelta);
+
+      switch(m_eDrawStyle){
+        case eDrawStyle::Vertical:
+          w.Put('M'); w.Put(nSrc); w.Put(' '); w.Put(a); w.Put('H'); w.Put(nDest);
+          break;
+
+        case eDrawStyle::Horizontal:
+          w.Put('M'); w.Put(a); w.Put(' '); w.Put(nSrc); w.Put('V'); w.Put(nDest);
+          break;
+      } //switch
+    } //for
+  } //for
+
+  if(bStarted)w.Put("\"/>");
+} //DrawCompactLevel
+
+/// Draw all comparators in compact SVG. The first time that a level with
+/// a new pattern of comparators is met, it is drawn by `DrawCompactLevel()`
+/// into a group in a `<defs>` element. Every level, including that one,
+/// is then drawn with a `<use>` of its pattern moved along the channels to
+/// where the level starts. Levels are matched by hash and then compared
+/// to make sure, so repeated levels such as the merge stages of a bitonic
+/// sorting network are written only once.
+
+void CRenderableComparatorNet::DrawCompactComparators(){
+  const CComparatorLayout& cLayout = GetLayout(m_eDrawStyle);
+  std::unordered_multimap<UINT64, UINT> mapPattern; //first level with each hash
+  CTextWriter& w = m_cOutput; //shorthand
+  float fLen = m_fYDelta + m_fYDelta2; //distance along channel
+
+  for(UINT i=0; i<m_nDepth; i++){ //for each level
+    const UINT64 h = HashLevel(cLayout, i); //hash of this level's pattern
+    const auto range = mapPattern.equal_range(h); //levels with the same hash
+    UINT nPattern = i; //level whose pattern this one has
+
+    for(auto it=range.first; it!=range.second && nPattern==i; it++)
+      if(SameLevel(cLayout, it->second, i))
+        nPattern = it->second;
+
+    if(nPattern == i){ //new pattern
+      mapPattern.emplace(h, i);
+
+      w.Put("<defs><g id=\"L"); w.Put(i); w.Put("\">");
+      DrawCompactLevel(cLayout, i, false);
+      DrawCompactLevel(cLayout, i, true);
+      w.Put("</g></defs>\n");
+    } //if
+
+    const int nStart = (UINT)std::round(fLen); //start of level along channels
+
+    w.Put("<use href=\"#L"); w.Put(nPattern);
+    w.Put(m_eDrawStyle == eDrawStyle::Vertical? "\" y=\"": "\" x=\"");
+    w.Put(nStart); w.Put("\"/>\n");
+
+    for(UINT pass=0; pass<cLayout.GetPasses(i); pass++) //same sums as DrawComparators()
+      fLen += m_fYDelta; //next pass
+
+    fLen += m_fYDelta2; //next level
+  } //for
+} //DrawCompactComparators
+
+/// Set whether SVG export is compact. Compact SVG looks the same but is
+/// several times smaller. Each level is drawn as one path for each color,
+/// the dots are markers, and a level that looks the same as an earlier one
+/// is drawn by reusing it.
+/// \param b True for compact SVG.
+
+void CRenderableComparatorNet::SetCompactSVG(const bool b){
+  m_bCompactSVG = b;
+} //SetCompactSVG
+
+/// Set the draw style, which determines whether the comparator network is
+/// exported vertically or horizontally. `Draw()` also sets it.
+/// \param d Draw style.
+
+void CRenderableComparatorNet::SetDrawStyle(const eDrawStyle d){
+  m_eDrawStyle = d;
+} //SetDrawStyle
+
+#ifdef _WIN32
+
 /// Draw the comparator network in black with a transparent background to a new
 /// `Gdiplus::Bitmap` of the right size. The comparator network is drawn either
 /// vertically or horzontally depending on the draw mode `m_eDrawStyle`. The
@@ -344,35 +634,206 @@ HRESULT CRenderableComparatorNet::ExportToPNG(LPWSTR lpwstr){
   return hr;
 } //ExportToPNG
 
+#endif //_WIN32
+
+/// Rasterize the part of the comparator network that falls in a tile, which
+/// is the window onto the canvas of a software rasterizer. The geometry is
+/// the same as in `DrawChannels()` and `DrawComparator()`, but only the
+/// channels and comparators that reach the tile are drawn. The levels that
+/// do are found by binary search on where they start along the channels,
+/// and the comparators in each of their passes that do by
+/// `CComparatorLayout::GetPass()`. They are drawn in the same order as
+/// `DrawChannels()` and `DrawComparators()` would draw them, so the tiles
+/// fit together seamlessly. This function doesn't change anything but the
+/// rasterizer, so tiles can be drawn on several threads at once.
+/// \param raster [IN, OUT] Rasterizer for the tile.
+/// \param cLayout Layout in the current draw style.
+/// \param vecStart Distance along the channels to the first pass of each
+/// level, followed by the length of the channels.
+
+void CRenderableComparatorNet::RasterizeTile(CRasterizer& raster,
+  const CComparatorLayout& cLayout, const std::vector<float>& vecStart) const
+{
+  const bool bVertical = m_eDrawStyle == eDrawStyle::Vertical; //shorthand
+  const float r = m_fDiameter/2; //circle radius for connectors
+  const float m = max(m_fDiameter, m_fPenWidth)/2 + 1; //reach past center line
+
+  const float x0 = raster.GetLeft() - 0.5f; //left edge of tile
+  const float x1 = x0 + raster.GetWidth(); //right edge of tile
+  const float y0 = raster.GetTop() - 0.5f; //top edge of tile
+  const float y1 = y0 + raster.GetHeight(); //bottom edge of tile
+
+  const float a0 = bVertical? y0: x0; //start of tile along the channels
+  const float a1 = bVertical? y1: x1; //end of tile along the channels
+  const float c0 = (bVertical? x0: y0) - r; //start of tile across the channels
+  const float c1 = (bVertical? x1: y1) - r; //end of tile across the channels
+
+  const float fLo = std::ceil((c0 - m)/m_fXDelta); //first channel reaching tile
+  const float fHi = std::floor((c1 + m)/m_fXDelta); //last channel reaching tile
+  if(fHi < 0.0f || fLo >= m_nInputs)return; //nothing to draw
+
+  //If the tile is between two channels then hi < lo, but the comparators
+  //between channels up to hi and channels from lo on still cross it.
+
+  const UINT lo = (UINT)max(fLo, 0.0f); //first channel to draw
+  const UINT hi = (UINT)min(fHi, m_nInputs - 1.0f); //last channel to draw
+  const float fLen = vecStart.back(); //length of channels
+
+  for(UINT k=lo; k<=hi; k++){ //for each channel reaching the tile
+    const float c = r + k*m_fXDelta; //distance across the channels
+
+    if(bVertical)raster.DrawLine(c, 0.0f, c, fLen, m_fPenWidth, 0xFF000000);
+    else raster.DrawLine(0.0f, c, fLen, c, m_fPenWidth, 0xFF000000);
+  } //for
+
+  const float fNext = a0 - m + m_fYDelta + m_fYDelta2; //next level starts at least here
+  UINT i = (UINT)(std::lower_bound(vecStart.begin() + 1, vecStart.end(), fNext) -
+    vecStart.begin()) - 1; //first level reaching the tile
+
+  for(; i<m_nDepth && vecStart[i] - m < a1; i++){ //for each level reaching the tile
+    const UINT nPasses = cLayout.GetPasses(i); //number of passes at this level
+    float fDist = vecStart[i]; //distance along channel
+
+    for(UINT pass=0; pass<nPasses; pass++){ //for each pass
+      if(fDist + m > a0 && fDist - m < a1){ //pass reaches tile
+        UINT n = 0; //number of comparators in this pass reaching the tile
+        const CComparator* pPass = cLayout.GetPass(i, pass, lo, hi, n);
+
+        for(UINT c=0; c<n; c++){ //for each of them in scan order
+          const CComparator& p = pPass[c]; //the comparator
+          const UINT argb = IsRed(i, p)? 0xFFFF0000: 0xFF000000; //red or black
+          const float fSrc  = r + p.m_nMax*m_fXDelta; //source across channels
+          const float fDest = r + p.m_nMin*m_fXDelta; //destination across channels
+
+          if(bVertical){
+            raster.FillCircle( fSrc, fDist, m_fDiameter, argb);
+            raster.FillCircle(fDest, fDist, m_fDiameter, argb);
+            raster.DrawLine(fSrc, fDist, fDest, fDist, m_fPenWidth, argb);
+          } //if
+
+          else{
+            raster.FillCircle(fDist,  fSrc, m_fDiameter, argb);
+            raster.FillCircle(fDist, fDest, m_fDiameter, argb);
+            raster.DrawLine(fDist, fSrc, fDist, fDest, m_fPenWidth, argb);
+          } //else
+        } //for
+      } //if
+
+      fDist += m_fYDelta; //next pass
+    } //for
+  } //for
+} //RasterizeTile
+
+/// Rasterize to a PNG file using the built-in software rasterizer instead
+/// of GDI+, so that it works everywhere. The image is the same size as the
+/// bitmap drawn by `Draw()`, drawn in the same order and in the same
+/// colors, with a transparent background. It is drawn in bands of rows
+/// that take up about 16 MB, or one row if that is larger, and each band
+/// is divided into tiles of about 256K pixels that are drawn by
+/// `RasterizeTile()` on separate threads. Each band is then compressed by
+/// the PNG file writer, also on separate threads, and written before the
+/// next is drawn. The memory used therefore doesn't grow with the height
+/// of the image.
+/// \param lpwstr Null terminated wide file name.
+/// \param nThreads Number of threads, or zero for one per hardware thread.
+/// \return S_OK if export succeeded, otherwise E_FAIL.
+
+HRESULT CRenderableComparatorNet::RasterizeToPNG(LPWSTR lpwstr, const UINT nThreads){
+  const CComparatorLayout& cLayout = GetLayout(m_eDrawStyle);
+  std::vector<float> vecStart(1, m_fYDelta + m_fYDelta2); //where levels start
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    vecStart.push_back(vecStart.back() + cLayout.GetPasses(i)*m_fYDelta + m_fYDelta2);
+
+  const UINT w = (UINT)std::ceil((m_nInputs - 1)*m_fXDelta + m_fPenWidth + m_fDiameter);
+  const UINT h = (UINT)std::ceil(vecStart.back());
+  const bool bVertical = m_eDrawStyle == eDrawStyle::Vertical; //shorthand
+
+  const UINT nWidth = bVertical? w: h; //image width
+  const UINT nHeight = bVertical? h: w; //image height
+
+  const UINT64 nBandBytes = 16 << 20; //bytes per band, roughly
+  const UINT64 nTilePixels = 256 << 10; //pixels per tile, roughly
+
+  const UINT64 nBandRows = max((UINT64)1, //rows per band
+    min((UINT64)nHeight, nBandBytes/(4*(UINT64)nWidth)));
+  const UINT nTileCols = (UINT)min((UINT64)nWidth, max((UINT64)1, nTilePixels/nBandRows));
+  const UINT nTiles = (nWidth + nTileCols - 1)/nTileCols; //tiles per band
+
+  UINT nWorkers = nThreads? nThreads: std::thread::hardware_concurrency();
+  nWorkers = max(1U, min(nWorkers, nTiles)); //no idle threads
+
+  std::vector<BYTE> vecBand; //pixels in a band
+  CPngWriter png; //PNG file writer
+  png.SetThreads(nThreads);
+
+  bool ok = png.Open(lpwstr, nWidth, nHeight);
+
+  for(UINT nTop=0; ok && nTop<nHeight; nTop+=(UINT)nBandRows){ //for each band
+    const UINT nRows = (UINT)min((UINT64)(nHeight - nTop), nBandRows); //rows in band
+    vecBand.resize(4*(size_t)nWidth*nRows);
+    std::atomic<UINT> nNext(0); //next tile to draw
+
+    auto DrawTiles = [&](){ //draw tiles until there are none left
+      CRasterizer raster; //software rasterizer
+
+      for(UINT t=nNext++; t<nTiles; t=nNext++){ //for each tile
+        const UINT nLeft = t*nTileCols; //leftmost column
+        const UINT nCols = min(nTileCols, nWidth - nLeft); //columns in tile
+
+        raster.Create(nLeft, nTop, nCols, nRows);
+        RasterizeTile(raster, cLayout, vecStart);
+        raster.Unpremultiply();
+
+        for(UINT j=0; j<nRows; j++) //copy tile into band
+          memcpy(&vecBand[4*((size_t)j*nWidth + nLeft)], raster.GetRow(j), 4*(size_t)nCols);
+      } //for
+    }; //DrawTiles
+
+    std::vector<std::thread> vecThread; //worker threads
+
+    for(UINT k=1; k<nWorkers; k++) //the first worker runs on this thread
+      vecThread.push_back(std::thread(DrawTiles));
+
+    DrawTiles();
+
+    for(std::thread& t: vecThread)
+      t.join();
+
+    ok = png.WriteRows(vecBand.data(), nRows);
+  } //for
+
+  ok = png.Close() && ok;
+  return ok? S_OK: E_FAIL;
+} //RasterizeToPNG
+
 /// Export to a TeX file. Note that `m_eExportType` is set to `eExport::TeX`
 /// so that the calls to `DrawComparators()` and DrawChannels()` output
-/// the necessary vector graphics commands in TeX format to the file pointed
-/// to by `m_pOutput`.
+/// the necessary vector graphics commands in TeX format to the file written
+/// by `m_cOutput`, which buffers them and writes them out in large blocks.
 /// \param lpwstr Null terminated wide file name.
 /// \return S_OK if export succeeded, otherwise E_FAIL.
 
 HRESULT CRenderableComparatorNet::ExportToTex(LPWSTR lpwstr){
-  _wfopen_s(&m_pOutput, lpwstr,  L"wt");
-
-  if(m_pOutput){
+  if(m_cOutput.Open(lpwstr)){
     m_eExportType = eExport::TeX;
     
     const UINT w = (UINT)std::ceil((m_nInputs - 1)*m_fXDelta + m_fPenWidth + m_fDiameter);
     const UINT h = (UINT)std::ceil(ComputeBitmapHeight());
     
-    fprintf_s(m_pOutput, "\\setlength{\\unitlength}{0.5pt}\n");
+    m_cOutput.Printf("\\setlength{\\unitlength}{0.5pt}\n");
 
     switch(m_eDrawStyle){   
       case eDrawStyle::Vertical:
-        fprintf_s(m_pOutput, "\\begin{picture}(%u,%u)(0,-%u)\n", w, h, h);
+        m_cOutput.Printf("\\begin{picture}(%u,%u)(0,-%u)\n", w, h, h);
         break;
 
       case eDrawStyle::Horizontal:
-        fprintf_s(m_pOutput, "\\begin{picture}(%u,%u)(0,-%u)\n", h, w, w);
+        m_cOutput.Printf("\\begin{picture}(%u,%u)(0,-%u)\n", h, w, w);
         break;
     } //switch
 
-    fprintf_s(m_pOutput, "\\thicklines\n");
+    m_cOutput.Printf("\\thicklines\n");
     
     //start drawing
 
@@ -381,13 +842,11 @@ HRESULT CRenderableComparatorNet::ExportToTex(LPWSTR lpwstr){
 
     //end drawing
 
-    fprintf_s(m_pOutput, "\\end{picture}\n"); //close the picture environment
+    m_cOutput.Printf("\\end{picture}\n"); //close the picture environment
 
     //clean up and exit
 
-    fclose(m_pOutput);
-    m_pOutput = nullptr; //safety
-    return S_OK;
+    return m_cOutput.Close()? S_OK: E_FAIL;
   } //if
 
   return E_FAIL;
@@ -395,18 +854,19 @@ HRESULT CRenderableComparatorNet::ExportToTex(LPWSTR lpwstr){
 
 /// Export to an SVG file. Note that `m_eExportType` is set to `eExport::Svg`
 /// so that the calls to `DrawComparators()` and DrawChannels()` output
-/// the necessary vector graphics commands in SVG format to the file pointed
-/// to by `m_pOutput`.
+/// the necessary vector graphics commands in SVG format to the file written
+/// by `m_cOutput`, which buffers them and writes them out in large blocks.
+/// If `m_bCompactSVG` is true, then `DrawCompactComparators()` and
+/// `DrawCompactChannels()` are called instead, and the style sheet and
+/// markers that they need are output first.
 /// \param lpwstr Null terminated wide file name.
 /// \return S_OK if export succeeded, otherwise E_FAIL.
 
 HRESULT CRenderableComparatorNet::ExportToSVG(LPWSTR lpwstr){
-  _wfopen_s(&m_pOutput, lpwstr,  L"wt");
-
-  if(m_pOutput){
+  if(m_cOutput.Open(lpwstr)){
     m_eExportType = eExport::Svg;
 
-    fprintf_s(m_pOutput, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"); //header
+    m_cOutput.Printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"); //header
 
     const UINT w = (UINT)std::ceil((m_nInputs - 1)*m_fXDelta +
       m_fPenWidth + m_fDiameter);
@@ -416,47 +876,87 @@ HRESULT CRenderableComparatorNet::ExportToSVG(LPWSTR lpwstr){
 
     switch(m_eDrawStyle){   
       case eDrawStyle::Vertical:
-        fprintf_s(m_pOutput, "<svg width=\"%u\" height=\"%u\" ", w + 8, h + 8);
-        fprintf_s(m_pOutput, "viewBox=\"-4 -4 %u %u\" ", w + 8, h + 8);
+        m_cOutput.Printf("<svg width=\"%u\" height=\"%u\" ", w + 8, h + 8);
+        m_cOutput.Printf("viewBox=\"-4 -4 %u %u\" ", w + 8, h + 8);
         break;
 
       case eDrawStyle::Horizontal:
-        fprintf_s(m_pOutput, "<svg width=\"%u\" height=\"%u\" ", h + 8, w + 8);
-        fprintf_s(m_pOutput, "viewBox=\"-4 -4 %u %u\" ", h + 8, w + 8);
+        m_cOutput.Printf("<svg width=\"%u\" height=\"%u\" ", h + 8, w + 8);
+        m_cOutput.Printf("viewBox=\"-4 -4 %u %u\" ", h + 8, w + 8);
         break;
     } //switch
 
-    fprintf_s(m_pOutput, "xmlns=\"http://www.w3.org/2000/svg\">\n");
+    m_cOutput.Printf("xmlns=\"http://www.w3.org/2000/svg\">\n");
 
     //style tag
 
-    fprintf_s(m_pOutput, "<style>\n");
-    fprintf_s(m_pOutput, "circle{fill:black;r:%0.1f}", m_fDiameter/2.0f);
-    fprintf_s(m_pOutput, "line{stroke:black;stroke-width:%0.1f}\n", m_fPenWidth);
-    fprintf_s(m_pOutput, "</style>\n");
+    m_cOutput.Printf("<style>\n");
+
+    if(m_bCompactSVG){
+      m_cOutput.Printf("path{fill:none;stroke:black;stroke-width:%0.1f}",
+        m_fPenWidth);
+      m_cOutput.Printf(".c{marker:url(#b)}.r{stroke:red;marker:url(#r)}\n");
+    } //if
+
+    else{
+      m_cOutput.Printf("circle{fill:black;r:%0.1f}", m_fDiameter/2.0f);
+      m_cOutput.Printf("line{stroke:black;stroke-width:%0.1f}\n", m_fPenWidth);
+    } //else
+
+    m_cOutput.Printf("</style>\n");
+
+    //markers for the dots in compact SVG
+
+    if(m_bCompactSVG){
+      const float r = m_fDiameter/2.0f; //circle radius for connectors
+
+      m_cOutput.Printf("<defs>\n");
+
+      for(UINT i=0; i<2; i++){ //black and red
+        m_cOutput.Printf("<marker id=\"%c\" markerUnits=\"userSpaceOnUse\" ",
+          i? 'r': 'b');
+        m_cOutput.Printf("markerWidth=\"%0.1f\" markerHeight=\"%0.1f\" ",
+          m_fDiameter, m_fDiameter);
+        m_cOutput.Printf("refX=\"%0.1f\" refY=\"%0.1f\" overflow=\"visible\">", r, r);
+        m_cOutput.Printf("<circle cx=\"%0.1f\" cy=\"%0.1f\" r=\"%0.1f\" fill=\"%s\"/>",
+          r, r, r, i? "red": "black");
+        m_cOutput.Printf("</marker>\n");
+      } //for
+
+      m_cOutput.Printf("</defs>\n");
+    } //if
     
     //start drawing
 
-    DrawChannels((float)h);
-    DrawComparators();
+    if(m_bCompactSVG){
+      DrawCompactChannels((float)h);
+      DrawCompactComparators();
+    } //if
+
+    else{
+      DrawChannels((float)h);
+      DrawComparators();
+    } //else
 
     //end drawing
 
-    fprintf_s(m_pOutput, "</svg>\n"); //close the svg tag
+    m_cOutput.Printf("</svg>\n"); //close the svg tag
 
     //clean up and exit
 
-    fclose(m_pOutput);
-    m_pOutput = nullptr; //safety
-    return S_OK;
+    return m_cOutput.Close()? S_OK: E_FAIL;
   } //if
 
   return E_FAIL;
 } //ExportToSVG
 
+#ifdef _WIN32
+
 /// Reader function for bitmap pointer.
 /// \return Pointer to bitmap.
 
 Gdiplus::Bitmap* CRenderableComparatorNet::GetBitmap(){
   return m_pBitmap;
-} //GetBitmap
\ No newline at end of file
+} //GetBitmap
+
+#endif //_WIN32
\ No newline at end of file
@@ -26,51 +26,100 @@
 #ifndef __RenderableComparatorNet_h__
 #define __RenderableComparatorNet_h__
 
+#ifdef _WIN32
+  #include "Includes.h"
+#endif
+
 #include "Defines.h"
 #include "ComparatorNetwork.h"
+#include "ComparatorLayout.h"
+#include "TextWriter.h"
+#include "Rasterizer.h"
 
 /// \brief Renderable comparator network.
 ///
 /// A comparator network that can be rendered to a `Gdiplus::Bitmap` or
-/// exported in one of several graphics file formats. Uses GDI+, obviously.
+/// exported in one of several graphics file formats. Uses GDI+, obviously,
+/// for the bitmap and for PNG export, which are only available on Windows.
+/// SVG and TeX export are written directly to a file, and PNG files can also
+/// be made by the built-in software rasterizer, so they are available
+/// everywhere.
+/// The layout of the comparators into passes is cached for each draw style
+/// and built again only when the comparator network changes. SVG export can
+/// optionally be made compact by drawing each level as a path with markers
+/// for the dots and drawing repeated levels with `<use>`. The software
+/// rasterizer draws the image in tiles on several threads, each tile
+/// drawing only the levels and comparators that reach it, and the tiles
+/// are streamed to the PNG file a band of rows at a time, so that the
+/// whole image is never in memory at once.
  
 class CRenderableComparatorNet: public CComparatorNetwork{
   protected:
-    const Gdiplus::REAL m_fPenWidth = 2.0f; ///< Pen width in pixels.
-    const Gdiplus::REAL m_fXDelta   = 24.0f; ///< Gap between channels in pixels.
-    const Gdiplus::REAL m_fYDelta   = 16.0f; ///< Vertical comparator gap in pixels.
-    const Gdiplus::REAL m_fYDelta2  = 8.0f; ///< Extra vertical gap between layers in pixels.
-    const Gdiplus::REAL m_fDiameter = 8.0f; ///< Diameter of circles in pixels.
-    
-    Gdiplus::Bitmap* m_pBitmap = nullptr; ///< Pointer to a bitmap image.
+    const float m_fPenWidth = 2.0f; ///< Pen width in pixels.
+    const float m_fXDelta   = 24.0f; ///< Gap between channels in pixels.
+    const float m_fYDelta   = 16.0f; ///< Vertical comparator gap in pixels.
+    const float m_fYDelta2  = 8.0f; ///< Extra vertical gap between layers in pixels.
+    const float m_fDiameter = 8.0f; ///< Diameter of circles in pixels.
 
     eDrawStyle m_eDrawStyle = eDrawStyle::Horizontal; ///< Drawing style.
+    bool m_bCompactSVG = false; ///< Whether SVG export is compact.
+
+#ifdef _WIN32
+    Gdiplus::Bitmap* m_pBitmap = nullptr; ///< Pointer to a bitmap image.
 
     Gdiplus::Graphics* m_pGraphics = nullptr; ///< Pointer to graphics object.
     Gdiplus::Pen* m_pPen = nullptr; ///< Pointer to graphics pen.
     Gdiplus::Pen* m_pRedPen = nullptr; ///< Pointer to graphics pen.
     Gdiplus::SolidBrush* m_pBrush = nullptr; ///< Pointer to graphics brush.
     Gdiplus::SolidBrush* m_pRedBrush = nullptr; ///< Pointer to graphics brush.
+#endif
 
-    FILE* m_pOutput = nullptr; ///< File pointer.
+    CTextWriter m_cOutput; ///< Output for SVG and TeX export.
     eExport m_eExportType = eExport::Png; ///< Export type.
 
-    Gdiplus::REAL ComputeBitmapHeight(); ///< Compute bitmap height.
+    CComparatorLayout m_cLayout[2]; ///< Cached layout for each draw style.
+
+    const CComparatorLayout& GetLayout(const eDrawStyle); ///< Get layout.
+    float ComputeBitmapHeight(); ///< Compute bitmap height.
 
     void DrawChannels(const float fLen); ///< Draw channels.
     void DrawComparator(const UINT, const UINT, const float, bool=false); ///< Draw a comparator.
     void DrawComparators(); ///< Draw all comparators.
 
+    const bool IsRed(const UINT, const CComparator&) const; ///< Whether drawn red.
+    const UINT64 HashLevel(const CComparatorLayout&, const UINT) const; ///< Hash a level.
+    const bool SameLevel(const CComparatorLayout&, const UINT, const UINT) const; ///< Compare levels.
+    void DrawCompactChannels(const float); ///< Draw channels in compact SVG.
+    void DrawCompactLevel(const CComparatorLayout&, const UINT, const bool); ///< Draw a level in compact SVG.
+    void DrawCompactComparators(); ///< Draw all comparators in compact SVG.
+
+    void RasterizeTile(CRasterizer&, const CComparatorLayout&,
+      const std::vector<float>&) const; ///< Rasterize a tile.
+
   public:
+    CRenderableComparatorNet() = default; ///< Default constructor.
+    CRenderableComparatorNet(const CRenderableComparatorNet&); ///< Copy constructor.
+    CRenderableComparatorNet(CRenderableComparatorNet&&) noexcept; ///< Move constructor.
     ~CRenderableComparatorNet(); ///< Destructor.
 
+    CRenderableComparatorNet& operator=(const CRenderableComparatorNet&); ///< Copy assignment.
+    CRenderableComparatorNet& operator=(CRenderableComparatorNet&&) noexcept; ///< Move assignment.
+
+    void SetDrawStyle(const eDrawStyle); ///< Set draw style.
+    void SetCompactSVG(const bool); ///< Set whether SVG export is compact.
+
+#ifdef _WIN32
     void Draw(const eDrawStyle); ///< Draw to a `Gdiplus::Bitmap`.
-    
     HRESULT ExportToPNG(LPWSTR); ///< Export in PNG format.
+#endif
+
     HRESULT ExportToTex(LPWSTR); ///< Export in TeX format.
+    HRESULT RasterizeToPNG(LPWSTR, const UINT=0); ///< Rasterize to a PNG file.
     HRESULT ExportToSVG(LPWSTR); ///< Export in SVG format.
 
+#ifdef _WIN32
     Gdiplus::Bitmap* GetBitmap(); ///< Get bitmap pointer.
+#endif
 }; //CRenderableComparatorNet
 
 #endif //__RenderableComparatorNet_h__
\ No newline at end of file
@@ -23,81 +23,121 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include "SortingNetwork.h"
-
-/// Delete the value table `m_nValue`, the usage array `m_bUsed`,
-/// and the Gray code generator.
+#include <chrono>
 
-CSortingNetwork::~CSortingNetwork(){
-  if(m_nValue){ //safety
-    for(UINT i=0; i<m_nDepth; i++)
-      delete [] m_nValue[i];
-    delete [] m_nValue;
-  } //if
-
-  if(m_bUsed){ //safety
-    for(UINT i=0; i<m_nDepth; i++)
-      delete [] m_bUsed[i];
-    delete [] m_bUsed;
+#include "SortingNetwork.h"
+#include "BitSlicedVerifier.h"
+#include "Checkpoint.h"
+#include "DenseBitmapVerifier.h"
+#include "ParallelVerifier.h"
+#include "PrefixVerifier.h"
+#include "ReachableSetVerifier.h"
+
+/// Copy constructor. The Gray code generator and the incremental verifier
+/// are working state that is rebuilt when needed, so they aren't copied.
+/// \param s Sorting network to copy.
+
+CSortingNetwork::CSortingNetwork(const CSortingNetwork& s):
+  CRenderableComparatorNet(s),
+  m_nValue(s.m_nValue),
+  m_eVerify(s.m_eVerify),
+  m_eVerified(s.m_eVerified),
+  m_eKernel(s.m_eKernel),
+  m_nThreads(s.m_nThreads),
+  m_nPrefix(s.m_nPrefix),
+  m_vFailed(s.m_vFailed),
+  m_vSetSize(s.m_vSetSize),
+  m_wstrCheckpoint(s.m_wstrCheckpoint),
+  m_nCheckpointSecs(s.m_nCheckpointSecs)
+{
+} //copy constructor
+
+/// Copy assignment, which makes a copy and moves it into place.
+/// \param s Sorting network to copy.
+/// \return This sorting network.
+
+CSortingNetwork& CSortingNetwork::operator=(const CSortingNetwork& s){
+  if(this != &s){
+    CSortingNetwork t(s); //copy
+    *this = std::move(t);
   } //if
 
-  delete m_pGrayCode;
-} //destructor
+  return *this;
+} //operator=
 
 /// Set the values on every channel between two levels to zero.
 /// \param firstlayer First level to set to zero.
 /// \param lastlayer Last level to set to zero.
 
 void CSortingNetwork::initValues(const UINT firstlayer, const UINT lastlayer){
-  for(UINT i=firstlayer; i<=lastlayer; i++) //for each layer in range
-    for(UINT j=0; j<m_nInputs; j++) //for each channel
-      m_nValue[i][j] = 0; //set the value on this channel at that layer to zero
+  m_nValue.Fill(firstlayer, lastlayer + 1, false); //a word at a time
 } //initValues
 
-/// Set the usage flag on every channel to a fixed value.
-/// \param b Value of flag.
-
- void CSortingNetwork::initUsage(){
-   const bool bFirstNormalForm = FirstNormalForm();
-
-  for(UINT j=0; j<m_nInputs; j++) //for each channel in first layer
-    m_bUsed[0][j] = bFirstNormalForm; //set the value on this channel at that layer to b
+/// Set the usage flag on every channel to unused, except in the first layer
+/// of a network in first normal form, where they are all used.
 
-  for(UINT i=1; i<m_nDepth; i++) //for each layer after the first
-    for(UINT j=0; j<m_nInputs; j++) //for each channel
-      m_bUsed[i][j] = false; //set the value on this channel at that layer to b
- } //initUsage
+void CSortingNetwork::initUsage(){
+  if(m_nDepth > 0){
+    m_bUsed.Fill(0, 1, FirstNormalForm()); //first layer
+    m_bUsed.Fill(1, m_nDepth, false); //the rest, a word at a time
+  } //if
+} //initUsage
 
 /// Initialize the network for the sorting test, that is, make the
 /// Gray code word for input be all zeros, and the values on every channel at
 /// every level be zero.
 
 void CSortingNetwork::initSortingTest(){ 
-  delete m_pGrayCode;
-  m_pGrayCode = FirstNormalForm()? new CTernaryGrayCode: new CBinaryGrayCode;
+  m_pGrayCode.reset(FirstNormalForm()? new CTernaryGrayCode: new CBinaryGrayCode);
 
   m_pGrayCode->Initialize(m_nInputs); //initialize the Gray code to all zeros.
   initValues(0, m_nDepth - 1); //initialize the network values to all zeros.
   initUsage(); //mark all comparators unused
 } //initSortingTest
 
-/// Flip value and propagate down the comparator network.
+/// Flip value and propagate down the comparator network. This picks the
+/// version of the loop for the width of the entries in the matching array.
 /// \param j Flip value in this channel.
 /// \param firstlayer Flip value at this layer.
 /// \param lastlayer Propagate change down to this layer.
 /// \return Channel whose value is flipped after the last layer.
 
 UINT CSortingNetwork::flipinput(UINT j, const UINT firstlayer, const UINT lastlayer){
+  switch(m_nMatch.GetWidth()){
+    case eIndexWidth::Bits8:  return flipinput(m_nMatch.GetArray<UINT8>(),  j, firstlayer, lastlayer);
+    case eIndexWidth::Bits16: return flipinput(m_nMatch.GetArray<UINT16>(), j, firstlayer, lastlayer);
+    default:                  return flipinput(m_nMatch.GetArray<UINT>(),   j, firstlayer, lastlayer);
+  } //switch
+} //flipinput
+
+/// Flip value and propagate down the comparator network, reading the
+/// matching array directly.
+/// \tparam T Type of entries in the matching array.
+/// \param nMatch Matching array.
+/// \param j Flip value in this channel.
+/// \param firstlayer Flip value at this layer.
+/// \param lastlayer Propagate change down to this layer.
+/// \return Channel whose value is flipped after the last layer.
+
+template<class T> UINT CSortingNetwork::flipinput(const CFlatArray<T>& nMatch,
+  UINT j, const UINT firstlayer, const UINT lastlayer)
+{
   for(UINT i=firstlayer; i<=lastlayer; i++){ //for each layer in range
-    m_nValue[i][j] ^= 1; //flip the value on channel j at that level
+    UINT64* nValue = m_nValue[i]; //values at this level, 64 channels per word
+    nValue[j >> 6] ^= 1ULL << (j & 63); //flip the value on channel j at that level
 
-    UINT k = m_nMatch[i][j]; //find the channel to which it is joined via a comparator, if any
+    UINT k = nMatch[i][j]; //find the channel to which it is joined via a comparator, if any
     
-    if(0 <= k && k < m_nInputs)
-      if((m_nValue[i][k] && j>k) || !(m_nValue[i][k] || j>k)){
-        m_bUsed[i][j] = m_bUsed[i][k] = true; //mark both channels used
+    if(0 <= k && k < m_nInputs){
+      const bool bValue = (nValue[k >> 6] >> (k & 63)) & 1; //value on channel k
+
+      if((bValue && j>k) || !(bValue || j>k)){
+        UINT64* bUsed = m_bUsed[i]; //usage at this level, 64 channels per word
+        bUsed[j >> 6] |= 1ULL << (j & 63); //mark both channels used
+        bUsed[k >> 6] |= 1ULL << (k & 63);
         j = k;
       } //if
+    } //if
   } //for
 
   return j;
@@ -112,23 +152,621 @@ bool CSortingNetwork::stillsorts(const int delta){
     m_pGrayCode->m_nZeros + m_pGrayCode->m_nGrayCodeWord[delta] - 1;
 } //stillsorts
 
-/// Check whether sorting network sorts all inputs. Set `m_bSorts` to `true`
-/// if it does.
+/// Check whether sorting network sorts all inputs by pushing one input at a
+/// time through the comparator network in Gray code order. If a checkpoint
+/// file has been set, then resume from it if it is for this comparator
+/// network, and save to it every `m_nCheckpointSecs` seconds and at the end.
+/// The clock is only read once every 65536 inputs, so the overhead of
+/// checkpointing is negligible.
 /// \return true if it sorts.
 
-bool CSortingNetwork::sorts(){ 
+bool CSortingNetwork::sortsGrayCode(){ 
   UINT i=0; //index of bit to flip
-  m_bSorts = true; //assume it sorts until we find otherwise
+  bool bSorts = true; //assume it sorts until we find otherwise
   initSortingTest(); //intialize input and values in comparator network to zero
+
+  const bool bCheckpoint = !m_wstrCheckpoint.empty(); //whether to checkpoint
+
+  if(bCheckpoint && resumeCheckpoint(bSorts)) //finished last time
+    return bSorts;
+
+  const auto interval = std::chrono::seconds(m_nCheckpointSecs); //time between checkpoints
+  auto next = std::chrono::steady_clock::now() + interval; //time of next checkpoint
+  UINT nCount = 0; //number of inputs tested, modulo 2^32
   
-  while(m_bSorts && i<=m_nInputs){ //bail if it doesn't sort, or we've tried all binary inputs
+  while(bSorts && i<=m_nInputs){ //bail if it doesn't sort, or we've tried all binary inputs
     i = m_pGrayCode->Next(); //next bit to flip in Gray code order
-    m_bSorts = m_bSorts && (i>m_nInputs || stillsorts(i)); //check whether it still sorts when this bit is flipped
+    bSorts = bSorts && (i>m_nInputs || stillsorts(i)); //check whether it still sorts when this bit is flipped
+
+    if(bCheckpoint && (++nCount & 0xFFFF) == 0 && bSorts && i<=m_nInputs &&
+      std::chrono::steady_clock::now() >= next)
+    {
+      saveCheckpoint(false, false); //not finished yet
+      next = std::chrono::steady_clock::now() + interval;
+    } //if
   } //while
 
+  if(!bSorts) //the current Gray code word isn't sorted
+    getgraycodeword(m_vFailed);
+
+  if(bCheckpoint)
+    saveCheckpoint(true, bSorts); //finished
+
+  return bSorts;
+} //sortsGrayCode
+
+/// Resume verification from the checkpoint file `m_wstrCheckpoint`. This
+/// must be called after `initSortingTest()`. If the checkpoint file doesn't
+/// exist, is corrupted, or is for a different comparator network, then it
+/// is ignored and will be overwritten at the next checkpoint. Otherwise the
+/// usage flags are restored and the Gray code generator is moved to the rank
+/// in the checkpoint. If verification has already finished and it didn't
+/// sort, then that is the Gray code word that wasn't sorted. If it hasn't
+/// finished, then the values at each level are recomputed by flipping the
+/// inputs that are one in that Gray code word, one at a time, starting from
+/// all zeros.
+/// \param bSorts [OUT] Whether it sorts, if verification has finished.
+/// \return true if verification finished in the checkpoint.
+
+bool CSortingNetwork::resumeCheckpoint(bool& bSorts){
+  CCheckpoint checkpoint; //the checkpoint
+
+  if(!checkpoint.Load(m_wstrCheckpoint) || checkpoint.m_nHash != GetHash() ||
+    checkpoint.m_nInputs != m_nInputs || checkpoint.m_nDepth != m_nDepth)
+    return false; //ignore it
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(UINT j=0; j<m_nInputs; j++) //for each channel
+      if(checkpoint.m_vUsed[i*m_nInputs + j])
+        m_bUsed.Set(i, j);
+
+  m_pGrayCode->Seek(checkpoint.m_nRank); //jump to the Gray code word
+
+  if(checkpoint.m_bFinished){
+    bSorts = checkpoint.m_bSorts;
+    if(!bSorts)getgraycodeword(m_vFailed); //the one that isn't sorted
+    return true;
+  } //if
+
+  for(UINT j=0; j<m_nInputs; j++) //for each channel
+    if(m_pGrayCode->m_nGrayCodeWord[j + 1]) //if the input is one
+      flipinput(j, 0, m_nDepth - 1); //flip it and propagate
+  
+  return false;
+} //resumeCheckpoint
+
+/// Save the current state of the Gray code verification engine to the
+/// checkpoint file `m_wstrCheckpoint`.
+/// If verification has finished and it doesn't sort, then the rank saved
+/// is that of the Gray code word that isn't sorted.
+/// \param bFinished Whether verification has finished.
+/// \param bSorts Whether it sorts, if verification has finished.
+
+void CSortingNetwork::saveCheckpoint(const bool bFinished, const bool bSorts){
+  CCheckpoint checkpoint; //the checkpoint
+
+  checkpoint.m_nInputs = m_nInputs;
+  checkpoint.m_nDepth = m_nDepth;
+  checkpoint.m_nHash = GetHash();
+  checkpoint.m_nRank = (bFinished && bSorts)? 0: m_pGrayCode->GetRank();
+  checkpoint.m_bFinished = bFinished;
+  checkpoint.m_bSorts = bSorts;
+  checkpoint.m_vUsed.resize(m_nDepth*m_nInputs);
+
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(UINT j=0; j<m_nInputs; j++) //for each channel
+      checkpoint.m_vUsed[i*m_nInputs + j] = m_bUsed(i, j);
+
+  checkpoint.Save(m_wstrCheckpoint);
+} //saveCheckpoint
+
+/// Check whether sorting network sorts all inputs by pushing 64 inputs per
+/// word at a time through the comparator network using a `CBitSlicedVerifier`
+/// with lane kernel `m_eKernel`, then copy its record of which comparators
+/// swapped into the usage array.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsBitSliced(){ 
+  m_eVerified = eVerify::BitSliced; //in case another engine fell back to this one
+
+  std::vector<CComparator>* vecLevel = new std::vector<CComparator>[m_nDepth];
+  GetComparators(vecLevel); //comparators at each level
+
+  CBitSlicedVerifier verifier(m_nInputs, vecLevel, m_nDepth, FirstNormalForm(),
+    m_eKernel);
+  delete [] vecLevel;
+
+  const bool bSorts = verifier.Verify(); //the heavy lifting
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    verifier.GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts)
+    verifier.GetCounterexample(m_vFailed);
+
+  return bSorts;
+} //sortsBitSliced
+
+/// Check whether sorting network sorts all inputs by splitting the Gray code
+/// (the ternary one if the network is in first normal form) into contiguous
+/// ranges and pushing one input at a time from each range through the
+/// comparator network on `m_nThreads` threads using a `CParallelVerifier`,
+/// then merge the usage arrays of the threads into the usage array. If there
+/// are 64 or more inputs, then we fall back to the bit-sliced version.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsParallel(){ 
+  CParallelVerifier verifier(m_nInputs, m_nMatch, m_nDepth, FirstNormalForm(),
+    m_nThreads);
+
+  if(!verifier.IsReady()) //refused
+    return sortsBitSliced();
+
+  const bool bSorts = verifier.Verify(); //the heavy lifting
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    verifier.GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts)
+    verifier.GetCounterexample(m_vFailed);
+
+  return bSorts;
+} //sortsParallel
+
+/// Check whether sorting network sorts all inputs by computing the set of
+/// zero-one vectors that can appear after each level using a 
+/// `CReachableSetVerifier`, then copy its record of which comparators
+/// swapped into the usage array and the size of the set after each level
+/// into `m_vSetSize`. If there are too many inputs, the set after the first
+/// level is too large, or memory runs out, then we fall back to the
+/// bit-sliced version.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsReachableSet(){ 
+  std::vector<CComparator>* vecLevel = new std::vector<CComparator>[m_nDepth];
+  GetComparators(vecLevel); //comparators at each level
+
+  CReachableSetVerifier verifier(m_nInputs, vecLevel, m_nDepth);
+  delete [] vecLevel;
+
+  if(!verifier.IsReady()) //refused
+    return sortsBitSliced();
+
+  const bool bSorts = verifier.Verify(); //the heavy lifting
+
+  if(!bSorts && verifier.OutOfMemory()) //gave up
+    return sortsBitSliced();
+
+  m_vSetSize = verifier.GetSetSizes();
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    verifier.GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts)
+    verifier.GetCounterexample(m_vFailed);
+
+  return bSorts;
+} //sortsReachableSet
+
+/// Check whether sorting network sorts all inputs by applying each comparator
+/// to a bitmap of all zero-one vectors using a `CDenseBitmapVerifier` on
+/// `m_nThreads` threads, then copy its record of which comparators swapped
+/// into the usage array. The memory needed can be found in advance with
+/// `GetBitmapBytes()`. If there are too many inputs or the bitmap can't be
+/// allocated, then we fall back to the bit-sliced version, which needs
+/// hardly any memory. The bitmap doesn't know which input wasn't sorted, so
+/// if it doesn't sort we get a counterexample from a `CBitSlicedVerifier`,
+/// which stops at the first input that isn't sorted.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsDenseBitmap(){ 
+  std::vector<CComparator>* vecLevel = new std::vector<CComparator>[m_nDepth];
+  GetComparators(vecLevel); //comparators at each level
+
+  CDenseBitmapVerifier verifier(m_nInputs, vecLevel, m_nDepth, m_nThreads);
+
+  if(!verifier.IsReady()){ //refused
+    delete [] vecLevel;
+    return sortsBitSliced();
+  } //if
+
+  const bool bSorts = verifier.Verify(); //the heavy lifting
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    verifier.GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts){ //find a counterexample
+    CBitSlicedVerifier bitsliced(m_nInputs, vecLevel, m_nDepth,
+      FirstNormalForm(), m_eKernel);
+
+    if(!bitsliced.Verify())
+      bitsliced.GetCounterexample(m_vFailed);
+  } //if
+
+  delete [] vecLevel;
+  return bSorts;
+} //sortsDenseBitmap
+
+/// Check whether sorting network sorts all inputs by computing the set of
+/// zero-one vectors that can appear after the first `m_nPrefix` levels, or
+/// a number of levels chosen automatically if that is zero, and pushing only
+/// those vectors through the remaining levels using a `CPrefixVerifier` with
+/// lane kernel `m_eKernel`. Then copy its record of which comparators swapped
+/// into the usage array and the size of the set after each level of the prefix
+/// into `m_vSetSize`. If there are too many inputs, the set after the
+/// first level is too large, or memory runs out, then we fall back to the
+/// bit-sliced version.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsPrefix(){ 
+  std::vector<CComparator>* vecLevel = new std::vector<CComparator>[m_nDepth];
+  GetComparators(vecLevel); //comparators at each level
+
+  CPrefixVerifier verifier(m_nInputs, vecLevel, m_nDepth, m_nPrefix, m_eKernel);
+  delete [] vecLevel;
+
+  if(!verifier.IsReady()) //refused
+    return sortsBitSliced();
+
+  const bool bSorts = verifier.Verify(); //the heavy lifting
+
+  if(!bSorts && verifier.OutOfMemory()) //gave up
+    return sortsBitSliced();
+
+  m_vSetSize = verifier.GetSetSizes();
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    verifier.GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts)
+    verifier.GetCounterexample(m_vFailed);
+
+  return bSorts;
+} //sortsPrefix
+
+/// Check whether sorting network sorts all inputs by bringing the sets of
+/// zero-one vectors after each level kept by a `CIncrementalVerifier` up to
+/// date, then copy its record of which comparators swapped into the usage
+/// array and the size of the set after each level into `m_vSetSize`. The
+/// verifier is kept between calls, so after a comparator is added with
+/// `AddComparator()` or removed with `RemoveComparator()`, only the levels
+/// from that one onward are recomputed, along with any that were too big to
+/// keep. If there are too many inputs, the sets won't fit into memory, or
+/// memory runs out, then we fall back to the bit-sliced version.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sortsIncremental(){ 
+  std::vector<CComparator>* vecLevel = new std::vector<CComparator>[m_nDepth];
+  GetComparators(vecLevel); //comparators at each level
+
+  if(m_pIncremental == nullptr)
+    m_pIncremental.reset(new CIncrementalVerifier);
+
+  const bool bReady = m_pIncremental->Update(m_nInputs, vecLevel, m_nDepth);
+  delete [] vecLevel;
+
+  if(!bReady) //refused
+    return sortsBitSliced();
+
+  const bool bSorts = m_pIncremental->Verify(); //the heavy lifting was in Update
+  m_vSetSize = m_pIncremental->GetSetSizes();
+
+  if(m_nDepth > 0){ //safety
+    initUsage(); //mark all comparators unused
+    m_pIncremental->GetUsage(m_bUsed); //mark the ones that swapped as used
+  } //if
+
+  if(!bSorts)
+    m_pIncremental->GetCounterexample(m_vFailed);
+
+  return bSorts;
+} //sortsIncremental
+
+/// Check whether sorting network sorts all inputs using the verification
+/// engine `m_eVerify`. Set `m_bSorts` to `true` if it does. If it doesn't,
+/// then the input that the engine found not to be sorted is saved for
+/// `GetCounterexample()`. The engines that fall back to the bit-sliced one
+/// do so through `sortsBitSliced()`, which records that in `m_eVerified`.
+/// \return true if it sorts.
+
+bool CSortingNetwork::sorts(){ 
+  m_vFailed.clear(); //no counterexample yet
+  m_vSetSize.clear(); //no reachable set sizes yet
+  m_eVerified = m_eVerify; //unless it falls back
+
+  switch(m_eVerify){
+    case eVerify::GrayCode:     m_bSorts = sortsGrayCode();     break;
+    case eVerify::BitSliced:    m_bSorts = sortsBitSliced();    break;
+    case eVerify::Parallel:     m_bSorts = sortsParallel();     break;
+    case eVerify::ReachableSet: m_bSorts = sortsReachableSet(); break;
+    case eVerify::DenseBitmap:  m_bSorts = sortsDenseBitmap();  break;
+    case eVerify::Prefix:       m_bSorts = sortsPrefix();       break;
+    case eVerify::Incremental:  m_bSorts = sortsIncremental();  break;
+  } //switch
+
   return m_bSorts;
 } //sorts
 
+/// Set the verification engine used by `sorts()`. They all give the same
+/// result and the same usage array, but some are faster than others.
+/// \param e Verification engine.
+
+void CSortingNetwork::SetVerify(const eVerify e){
+  m_eVerify = e;
+} //SetVerify
+
+/// Set the lane kernel used by the bit-sliced verification engine. The 
+/// default is the fastest one supported by this processor. If the processor
+/// doesn't support the one requested, then the portable kernel is used.
+/// \param k Lane kernel.
+
+void CSortingNetwork::SetKernel(const eKernel k){
+  m_eKernel = k;
+} //SetKernel
+
+/// Set the number of threads used by the parallel verification engine. 
+/// The default is one per hardware thread.
+/// \param n Number of threads, or zero for one per hardware thread.
+
+void CSortingNetwork::SetThreads(const UINT n){
+  m_nThreads = n;
+} //SetThreads
+
+/// Set the number of levels in the prefix used by the prefix reduction
+/// verification engine. The default is to choose it automatically. The
+/// number of levels actually used is the number of entries in
+/// `GetSetSizes()` after verification.
+/// \param n Number of levels, or zero to choose automatically.
+
+void CSortingNetwork::SetPrefix(const UINT n){
+  m_nPrefix = n;
+} //SetPrefix
+
+/// Set the checkpoint file for the Gray code verification engine, which
+/// saves its progress to this file periodically and resumes from it if it
+/// already exists. This allows a long verification run to be restarted
+/// after a crash without losing more than a few minutes of work. The other
+/// verification engines ignore it.
+/// \param wstrName Checkpoint file name, or the empty string for none.
+/// \param nSecs Number of seconds between checkpoints.
+
+void CSortingNetwork::SetCheckpoint(const std::wstring& wstrName, const UINT nSecs){
+  m_wstrCheckpoint = wstrName;
+  m_nCheckpointSecs = nSecs;
+} //SetCheckpoint
+
+/// Check that the bit-sliced verification engine with each lane kernel
+/// supported by this processor gets the same result as the Gray code version
+/// using `flipinput()`, that is, the same answer to whether it sorts and
+/// (if it does) the same number of unused comparators. The verification
+/// engine and lane kernel are left unchanged.
+/// \return true if all of the lane kernels agree with the Gray code version.
+
+bool CSortingNetwork::SelfTest(){
+  const eKernel eOldKernel = m_eKernel; //so we can restore it later
+  const bool bSorts = sortsGrayCode(); //the reference result
+  const UINT nUnused = GetUnused(); //the reference number of unused comparators
+
+  bool ok = true; //true if all kernels agree so far
+
+  for(eKernel k: {eKernel::Scalar, eKernel::Avx2, eKernel::Avx512})
+    if(KernelSupported(k)){
+      m_eKernel = k;
+      const bool b = sortsBitSliced(); //result for this kernel
+      ok = ok && b == bSorts && (!b || GetUnused() == nUnused);
+    } //if
+
+  m_eKernel = eOldKernel; //restore
+  m_bSorts = bSorts;
+  
+  return ok;
+} //SelfTest
+
+/// Push a zero-one input through the comparator network, one comparator
+/// at a time from the comparator lists, so that this takes time proportional
+/// to the size.
+/// \param v [IN, OUT] Input on each channel, replaced by the output.
+
+void CSortingNetwork::evaluate(std::vector<UINT>& v) const{
+  for(UINT i=0; i<m_nDepth; i++) //for each level
+    for(const CComparator& c: m_vecLevel[i]) //for each comparator
+      if(v[c.m_nMin] > v[c.m_nMax])
+        std::swap(v[c.m_nMin], v[c.m_nMax]);
+} //evaluate
+
+/// Find the number of levels after which an input that isn't sorted can
+/// no longer be sorted by the rest of the comparator network. If the input
+/// has \f$z\f$ zeros then the output should have zeros on the first \f$z\f$
+/// channels and ones on the rest. Follow each value through the comparator
+/// network, where a comparator only moves values when it swaps. A one can
+/// only be moved to a larger channel by a comparator, and a zero to a smaller
+/// one, so working backwards from the last level we can find which channels
+/// at each level a one could still get from to one of the last channels, or
+/// a zero to one of the first channels. The answer is the first level at which
+/// a value that ends up in the wrong place is on a channel that it can't get
+/// out of.
+/// \param vInput Zero-one input that isn't sorted.
+/// \return Number of levels, zero if the input itself can't be sorted.
+
+UINT CSortingNetwork::strandedlevel(const std::vector<UINT>& vInput) const{
+  UINT nZeros = 0; //number of zeros
+
+  for(UINT j=0; j<m_nInputs; j++)
+    nZeros += 1 - vInput[j];
+
+  //bOne[i*n + j] is true if a one on channel j after i levels can get to the
+  //last channels, bZero[i*n + j] similarly for a zero and the first channels
+
+  const UINT n = m_nInputs; //shorthand
+  std::vector<bool> bOne((m_nDepth + 1)*n), bZero((m_nDepth + 1)*n);
+
+  for(UINT j=0; j<n; j++){ //after the last level
+    bOne[m_nDepth*n + j] = j >= nZeros;
+    bZero[m_nDepth*n + j] = j < nZeros;
+  } //for
+
+  for(UINT i=m_nDepth; i>0; i--){ //for each level, last first
+    for(UINT j=0; j<n; j++){ //a value can stay where it is
+      bOne[(i - 1)*n + j] = bOne[i*n + j];
+      bZero[(i - 1)*n + j] = bZero[i*n + j];
+    } //for
+
+    for(const CComparator& c: m_vecLevel[i - 1]){ //or be moved by a comparator
+      if(bOne[i*n + c.m_nMax])bOne[(i - 1)*n + c.m_nMin] = true;
+      if(bZero[i*n + c.m_nMin])bZero[(i - 1)*n + c.m_nMax] = true;
+    } //for
+  } //for
+
+  //follow the values, where nWhere[t] is the channel of the value that was
+  //input on channel t
+
+  std::vector<UINT> v(vInput); //values on each channel
+  std::vector<UINT> nWhere(n), nWho(n); //channel of each value, and vice-versa
+  std::vector<UINT> nStranded(n, m_nDepth + 1); //level each value was stranded
+
+  for(UINT t=0; t<n; t++)
+    nWhere[t] = nWho[t] = t;
+
+  for(UINT i=0; i<=m_nDepth; i++){ //after each number of levels
+    for(UINT t=0; t<n; t++){ //for each value
+      const std::vector<bool>& b = vInput[t]? bOne: bZero; //for ones or zeros
+      
+      if(nStranded[t] > m_nDepth && !b[i*n + nWhere[t]])
+        nStranded[t] = i; //stranded here
+    } //for
+
+    if(i < m_nDepth) //push through level i
+      for(const CComparator& c: m_vecLevel[i]){ //for each comparator
+        const UINT j = c.m_nMin, k = c.m_nMax; //shorthand
+
+        if(v[j] > v[k]){ //swap
+          std::swap(v[j], v[k]);
+          std::swap(nWho[j], nWho[k]);
+          nWhere[nWho[j]] = j;
+          nWhere[nWho[k]] = k;
+        } //if
+      } //for
+  } //for
+
+  UINT nLevel = m_nDepth; //result
+
+  for(UINT t=0; t<n; t++) //for each value
+    nLevel = min(nLevel, nStranded[t]);
+
+  return nLevel;
+} //strandedlevel
+
+/// Get the current Gray code word.
+/// \param v [OUT] Gray code word, one entry per channel.
+
+void CSortingNetwork::getgraycodeword(std::vector<UINT>& v) const{
+  v.resize(m_nInputs);
+
+  for(UINT j=0; j<m_nInputs; j++)
+    v[j] = m_pGrayCode->m_nGrayCodeWord[j + 1];
+} //getgraycodeword
+
+/// Get a counterexample showing that the comparator network doesn't sort,
+/// starting with the first input that the verification engine found that
+/// isn't sorted, or the one found by `MinimizeCounterexample()`. Assumes that
+/// function `sorts()` has already been run.
+/// \param c [OUT] Counterexample.
+/// \return true if there is a counterexample, false if it sorts or if
+/// `sorts()` hasn't been run.
+
+bool CSortingNetwork::GetCounterexample(CCounterexample& c) const{
+  if(m_vFailed.empty())return false; //bail and fail
+
+  c.m_vInput = c.m_vOutput = m_vFailed;
+  evaluate(c.m_vOutput);
+  c.m_nLevel = strandedlevel(m_vFailed);
+
+  return true;
+} //GetCounterexample
+
+/// Replace the counterexample found by `sorts()` with the simplest one,
+/// which is the input with the fewest ones or the fewest zeros that isn't
+/// sorted. Try the inputs with \f$w\f$ ones and the inputs with \f$w\f$ zeros
+/// for \f$w = 1, 2, \ldots\f$, stopping when we find one that isn't sorted
+/// or when \f$w\f$ reaches that of the counterexample that we already have.
+/// Each input takes time proportional to the size, and there are
+/// \f$2\binom{n}{w}\f$ of them for each \f$w\f$ on \f$n\f$ inputs, so in the
+/// worst case, when the counterexample has about as many ones as zeros, this
+/// tries \f$2\sum_{w < n/2} \binom{n}{w}\f$ inputs, which is close to
+/// \f$2^n\f$. That is as many as `sorts()` itself, so it may take a while.
+/// \return true if there is a counterexample, false if it sorts or if
+/// `sorts()` hasn't been run.
+
+bool CSortingNetwork::MinimizeCounterexample(){
+  if(m_vFailed.empty())return false; //bail and fail
+
+  UINT nOnes = 0; //number of ones in current counterexample
+
+  for(UINT j=0; j<m_nInputs; j++)
+    nOnes += m_vFailed[j];
+
+  const UINT nBest = min(nOnes, m_nInputs - nOnes); //what we have to beat
+  std::vector<UINT> nIndex, v; //combination, and input
+
+  for(UINT w=1; w<nBest; w++){ //for each number of ones or zeros
+    for(UINT b: {1U, 0U}){ //ones on combination, then zeros
+      nIndex.resize(w);
+
+      for(UINT t=0; t<w; t++) //first combination
+        nIndex[t] = t;
+
+      bool bMore = true; //whether there are more combinations
+
+      while(bMore){
+        v.assign(m_nInputs, 1 - b); //all zeros or all ones
+
+        for(UINT t=0; t<w; t++) //combination gets the opposite
+          v[nIndex[t]] = b;
+
+        std::vector<UINT> vOutput(v); //output
+        evaluate(vOutput);
+        bool bSorted = true; //whether output is sorted
+
+        for(UINT j=0; j+1<m_nInputs && bSorted; j++)
+          bSorted = vOutput[j] <= vOutput[j + 1];
+
+        if(!bSorted){ //found one
+          m_vFailed = v;
+          return true;
+        } //if
+
+        //next combination of w of the channels
+
+        UINT t = w; //index into combination
+
+        while(t > 0 && nIndex[t - 1] == m_nInputs - w + t - 1)
+          --t;
+
+        bMore = t > 0;
+
+        if(bMore){
+          ++nIndex[t - 1];
+
+          for(UINT u=t; u<w; u++)
+            nIndex[u] = nIndex[u - 1] + 1;
+        } //if
+      } //while
+    } //for
+  } //for
+
+  return true;
+} //MinimizeCounterexample
+
 /// Get number of unused comparators. Assumes that function `sorts()` has
 /// already been run. Returns zero otherwise.
 /// \return Number of unused comparators.
@@ -136,52 +774,75 @@ bool CSortingNetwork::sorts(){
 const UINT CSortingNetwork::GetUnused() const{
   UINT count = 0;
 
-  if(m_bUsed){
+  if(!m_bUsed.IsEmpty()){
     for(UINT i=0; i<m_nDepth; i++) //for each level
-      for(UINT j=0; j<m_nInputs; j++) //for each channel
-        if(m_nMatch[i][j] > j && !m_bUsed[i][j])
+      for(const CComparator& c: m_vecLevel[i]) //for each comparator
+        if(!m_bUsed(i, c.m_nMin))
           count++;
   } //if
 
   return count;
 } //GetUnused
 
+/// Get the number of distinct zero-one vectors that can appear after each
+/// level, as computed by the reachable set or incremental verification
+/// engines, or after each level of the prefix for the prefix reduction
+/// verification engine. Assumes that function `sorts()` has already been run
+/// with one of those engines. Returns an empty vector otherwise.
+/// \return Set size after each level.
+
+const std::vector<UINT64>& CSortingNetwork::GetSetSizes() const{
+  return m_vSetSize;
+} //GetSetSizes
+
+/// Get the amount of memory needed by the dense bitmap verification engine,
+/// so that the caller can decide whether to use it.
+/// \return Number of bytes, or zero if there are too many inputs.
+
+const UINT64 CSortingNetwork::GetBitmapBytes() const{
+  return CDenseBitmapVerifier::GetBytes(m_nInputs);
+} //GetBitmapBytes
+
+/// Get the verification engine set by `SetVerify()`.
+/// \return Verification engine.
+
+const eVerify CSortingNetwork::GetVerify() const{
+  return m_eVerify;
+} //GetVerify
+
+/// Get the verification engine that the last call to `sorts()` actually
+/// ran, which is the bit-sliced one if the engine set by `SetVerify()`
+/// refused the comparator network or ran out of memory.
+/// \return Verification engine.
+
+const eVerify CSortingNetwork::GetVerified() const{
+  return m_eVerified;
+} //GetVerified
+
 /// Create and initialize value array to all zeros. Assumes that `m_nInputs`
 /// and `m_nDepth` have been set to the correct values.
 
 void CSortingNetwork::CreateValueArray(){
-  m_nValue = new UINT*[m_nDepth];
-
-  for(UINT i=0; i<m_nDepth; i++){
-    m_nValue[i] = new UINT[m_nInputs];
-
-    for(UINT j=0; j<m_nInputs; j++)
-      m_nValue[i][j] = 0;
-  } //for
+  m_nValue.Create(m_nDepth, m_nInputs, false);
 } //CreateValueArray
 
-/// Create and initialize usage array to all usde. Assumes that `m_nInputs`
+/// Create and initialize usage array to all used. Assumes that `m_nInputs`
 /// and `m_nDepth` have been set to the correct values.
 
 void CSortingNetwork::CreateUsageArray(){
-  m_bUsed = new bool*[m_nDepth];
-
-  for(UINT i=0; i<m_nDepth; i++){
-    m_bUsed[i] = new bool[m_nInputs];
-
-    for(UINT j=0; j<m_nInputs; j++)
-      m_bUsed[i][j] = true;
-  } //for
+  m_bUsed.Create(m_nDepth, m_nInputs, true);
 } //CreateUsageArray
 
-/// Read a sorting network and create and initialize the value array `m_nValue`
-/// for use in sorting verification. Uses `CComparatorNetwork::Read()` to do
-/// the heavy lifting.
-/// \param lpwstr Null terminated wide file name.
+/// Read a sorting network from the contents of a text or binary file and
+/// create and initialize the value array `m_nValue` for use in sorting
+/// verification. Uses `CComparatorNetwork::ReadImage()` to do the heavy
+/// lifting. This is called by `CComparatorNetwork::Read()`.
+/// \param p Pointer to the file contents.
+/// \param n Size of the file contents in bytes.
 /// \return true if the input succeeded.
 
-bool CSortingNetwork::Read(LPWSTR lpwstr){
-  const bool ok = CComparatorNetwork::Read(lpwstr); //read from file
+bool CSortingNetwork::ReadImage(const BYTE* p, const size_t n){
+  const bool ok = CComparatorNetwork::ReadImage(p, n); //read from memory
 
   if(ok){
     CreateValueArray(); //create and initialize value array to all zeros
@@ -189,4 +850,18 @@ bool CSortingNetwork::Read(LPWSTR lpwstr){
   } //if
 
   return ok;
-} //Read
\ No newline at end of file
+} //ReadImage
+
+/// Move each comparator to the earliest level that it can go in and delete
+/// any empty levels using `CComparatorNetwork::Relayer()`, then recreate the
+/// value array for the new depth. The reachable set sizes, which were for
+/// the old levels, are discarded. Whether it sorts doesn't change.
+/// \param nOldDepth [OUT] Depth before.
+/// \param nNewDepth [OUT] Depth after.
+
+void CSortingNetwork::Relayer(UINT& nOldDepth, UINT& nNewDepth){
+  CComparatorNetwork::Relayer(nOldDepth, nNewDepth);
+
+  CreateValueArray();
+  m_vSetSize.clear();
+} //Relayer
\ No newline at end of file
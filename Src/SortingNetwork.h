@@ -26,10 +26,31 @@
 #ifndef __SortingNetwork_h__
 #define __SortingNetwork_h__
 
-#include "WindowsHelpers.h"
+#include <memory>
+
+#include "Platform.h"
 
 #include "TernaryGrayCode.h"
 #include "RenderableComparatorNet.h"
+#include "LaneKernels.h"
+#include "IncrementalVerifier.h"
+
+/// \brief Counterexample.
+///
+/// A zero-one input that a comparator network fails to sort, the output that
+/// it produces, and the number of levels after which the input can no longer
+/// be sorted by the rest of the comparator network, however the comparators
+/// on the remaining levels behave. That is, some value that ends up on the
+/// wrong side of the boundary between the zeros and ones in the output is
+/// on a channel from which none of the remaining comparators can take it
+/// back across the boundary.
+
+class CCounterexample{
+  public:
+    std::vector<UINT> m_vInput; ///< Zero-one input, one entry per channel.
+    std::vector<UINT> m_vOutput; ///< Output, which is not sorted.
+    UINT m_nLevel = 0; ///< Number of levels after which it can't be sorted.
+}; //CCounterexample
 
 /// \brief Sorting network
 ///
@@ -42,25 +63,72 @@
 
 class CSortingNetwork: public CRenderableComparatorNet{
   protected: 
-    CBinaryGrayCode *m_pGrayCode = nullptr; ///< Gray code generator.
-    UINT** m_nValue = nullptr; ///< Values at each level when sorting.
+    std::unique_ptr<CBinaryGrayCode> m_pGrayCode; ///< Gray code generator.
+    std::unique_ptr<CIncrementalVerifier> m_pIncremental; ///< Sets kept between edits.
+    CBitArray m_nValue; ///< Values at each level when sorting.
+    eVerify m_eVerify = eVerify::BitSliced; ///< Verification engine.
+    eVerify m_eVerified = eVerify::BitSliced; ///< Engine that `sorts()` last ran.
+    eKernel m_eKernel = BestKernel(); ///< Lane kernel for bit-sliced engine.
+    UINT m_nThreads = 0; ///< Number of threads for parallel engine, 0 for all.
+    UINT m_nPrefix = 0; ///< Number of levels in prefix for prefix engine, 0 for automatic.
+
+    std::vector<UINT> m_vFailed; ///< First input found that isn't sorted, if any.
+    std::vector<UINT64> m_vSetSize; ///< Reachable set size after each level.
+
+    std::wstring m_wstrCheckpoint; ///< Checkpoint file name, empty for none.
+    UINT m_nCheckpointSecs = 600; ///< Seconds between checkpoints.
 
     void initSortingTest(); ///< Initialize the sorting test.
     bool stillsorts(const int delta); ///< Does it still sort when a bit is changed?
 
     UINT flipinput(UINT j, const UINT firstlayer, const UINT lastlayer); ///< Recompute network values when a bit is changed.
+    template<class T> UINT flipinput(const CFlatArray<T>&, UINT, const UINT, const UINT); ///< Same, for one index width.
     void initValues(const UINT firstlayer, const UINT lastlayer); ///< Initialize the network values to the all zero input.
     void initUsage(); ///< Initialize usage array.
     void CreateValueArray(); ///< Make value array.
     void CreateUsageArray(); ///< Make usage array.
 
+    void evaluate(std::vector<UINT>&) const; ///< Push input through network.
+    UINT strandedlevel(const std::vector<UINT>&) const; ///< Find unrecoverable level.
+    void getgraycodeword(std::vector<UINT>&) const; ///< Get Gray code word.
+
+    bool resumeCheckpoint(bool&); ///< Resume from checkpoint file.
+    void saveCheckpoint(const bool, const bool); ///< Save checkpoint file.
+
+    bool sortsGrayCode(); ///< Does it sort? Gray code version.
+    bool sortsBitSliced(); ///< Does it sort? Bit-sliced version.
+    bool sortsParallel(); ///< Does it sort? Multithreaded version.
+    bool sortsReachableSet(); ///< Does it sort? Reachable set version.
+    bool sortsDenseBitmap(); ///< Does it sort? Dense bitmap version.
+    bool sortsPrefix(); ///< Does it sort? Prefix reduction version.
+    bool sortsIncremental(); ///< Does it sort? Incremental version.
+
   public:
-    ~CSortingNetwork(); ///< Destructor.
+    CSortingNetwork() = default; ///< Default constructor.
+    CSortingNetwork(const CSortingNetwork&); ///< Copy constructor.
+    CSortingNetwork(CSortingNetwork&&) = default; ///< Move constructor.
+
+    CSortingNetwork& operator=(const CSortingNetwork&); ///< Copy assignment.
+    CSortingNetwork& operator=(CSortingNetwork&&) = default; ///< Move assignment.
 
-    bool Read(LPWSTR); ///< Read from file.
+    bool ReadImage(const BYTE*, const size_t); ///< Read from file contents.
+    void Relayer(UINT&, UINT&); ///< Move comparators to earliest levels.
     bool sorts(); ///< Does it sort?
+    void SetVerify(const eVerify); ///< Set verification engine.
+    void SetKernel(const eKernel); ///< Set lane kernel.
+    void SetThreads(const UINT); ///< Set number of threads.
+    void SetPrefix(const UINT); ///< Set number of levels in prefix.
+    void SetCheckpoint(const std::wstring&, const UINT=600); ///< Set checkpoint file.
+    bool SelfTest(); ///< Test lane kernels against Gray code.
+
+    bool GetCounterexample(CCounterexample&) const; ///< Get unsorted input.
+    bool MinimizeCounterexample(); ///< Find simplest unsorted input.
     
     const UINT GetUnused() const; ///< Get number of unused comparators.
+    const std::vector<UINT64>& GetSetSizes() const; ///< Get reachable set sizes.
+    const UINT64 GetBitmapBytes() const; ///< Get memory for dense bitmap.
+    const eVerify GetVerify() const; ///< Get verification engine.
+    const eVerify GetVerified() const; ///< Get engine that ran.
 }; //CSortingNetwork
 
 #endif //__SortingNetwork_h__
\ No newline at end of file
@@ -22,7 +22,11 @@ void CTernaryGrayCode::Initialize(const UINT n){
 } //Initialize
 
 /// Get the next binary word in ternary reflected Gray code order, which will
-/// differ from the previous one in exactly one bit.
+/// differ from the previous one in exactly one bit. If the number of bits is
+/// odd, then the last bit is paired with a phantom bit past the end of the
+/// word. The last bit must be flipped from 0 to 1 before the phantom bit is
+/// flipped to signal that we're finished, otherwise the inputs with a 1 on the
+/// unpaired channel are never generated.
 /// \return Index of the bit that has changed, in the range 1..INPUTS. 
 /// Out of range means we're finished.
 
@@ -30,6 +34,9 @@ UINT CTernaryGrayCode::Next(){
   UINT i = m_nGrayCodeStack[0]; 
   m_nGrayCodeStack[0] = 1;
   UINT j = 2*i - m_nGrayCodeWord[2*i - m_nDirection[i]];
+
+  if(2*i - 1 == m_nSize && m_nGrayCodeWord[m_nSize] == 0) //unpaired last bit
+    j = m_nSize;
   m_nGrayCodeWord[j] ^= 1;
 
   if(m_nGrayCodeWord[2*i] == m_nGrayCodeWord[2*i - 1]){
@@ -41,4 +48,81 @@ UINT CTernaryGrayCode::Next(){
   m_nZeros += 1 - 2*m_nGrayCodeWord[j]; 
 
   return j;
-} //Next
\ No newline at end of file
+} //Next
+
+/// Set the Gray code generator to the word with a given rank in ternary
+/// reflected Gray code order, that is, the word that would be reached by
+/// that many calls to `Next()` after `Initialize()`, in time linear in the
+/// number of bits. The rank is written in mixed radix, with one ternary
+/// digit per bit pair and (if the number of bits is odd) a binary digit for
+/// the unpaired last bit. Each digit of the word is the corresponding digit
+/// of the rank, reflected if the number formed by the digits above it is odd.
+/// A bit pair's direction is flipped once more if its digit of the rank is 2,
+/// since it has already reached the end and turned around. The recursion
+/// stack is the identity except that for each maximal run of bit pairs whose
+/// digits of the rank are 2, the entry for the first one points past the end
+/// of the run. Assumes that `Initialize()` has already been called.
+/// \param r Rank, which must be less than the number of code words.
+
+void CTernaryGrayCode::Seek(const UINT64 r){
+  m_nZeros = m_nSize; 
+
+  for(UINT i=0; i<m_nSize+3; i++){
+    m_nGrayCodeWord[i] = 0; 
+    m_nGrayCodeStack[i] = i + 1; 
+    m_nDirection[i] = 0;
+  } //for
+
+  UINT64 nHigh = r; //the number formed by the digits not yet processed
+  UINT nStart = 0; //start of current run of 2s in the rank
+  bool bPrev = false; //whether previous digit of the rank is 2
+
+  for(UINT i=1; 2*i-1<=m_nSize; i++){ //for each bit pair
+    const bool bPair = 2*i <= m_nSize; //false for the unpaired last bit
+    const UINT nRadix = bPair? 3: 2;
+
+    const UINT d = (UINT)(nHigh%nRadix); //digit of the rank
+    nHigh /= nRadix; //digits above this one
+    const UINT g = (nHigh & 1)? nRadix - 1 - d: d; //digit of the word
+
+    if(bPair){
+      m_nGrayCodeWord[2*i] = g > 0;
+      m_nGrayCodeWord[2*i - 1] = g > 1;
+      m_nDirection[i] = (int)((nHigh + (d == 2)) & 1);
+    } //if
+
+    else m_nGrayCodeWord[2*i - 1] = g; //unpaired last bit
+
+    m_nZeros -= m_nGrayCodeWord[2*i - 1] + m_nGrayCodeWord[2*i]; //adjust zero count
+
+    const bool b = bPair && d == 2; //whether this digit of the rank is 2
+
+    if(b){ //in a run of 2s
+      if(!bPrev)nStart = i - 1; //start of the run
+      m_nGrayCodeStack[nStart] = i + 1; //point past the end of the run so far
+    } //if
+
+    bPrev = b;
+  } //for
+} //Seek
+
+/// Get the rank of the current word in ternary reflected Gray code order,
+/// that is, the number of calls to `Next()` needed to reach it after
+/// `Initialize()`. This is the inverse of `Seek()`, working down from the
+/// most significant digit and unreflecting each digit of the word if the
+/// number formed by the digits of the rank above it is odd.
+/// \return Rank of the current word.
+
+const UINT64 CTernaryGrayCode::GetRank() const{
+  UINT64 r = 0; //the rank
+
+  for(UINT i=(m_nSize + 1)/2; i>=1; i--){ //from the most significant digit down
+    const bool bPair = 2*i <= m_nSize; //false for the unpaired last bit
+    const UINT nRadix = bPair? 3: 2;
+    const UINT g = m_nGrayCodeWord[2*i - 1] + (bPair? m_nGrayCodeWord[2*i]: 0);
+
+    r = r*nRadix + ((r & 1)? nRadix - 1 - g: g);
+  } //for
+
+  return r;
+} //GetRank
@@ -74,6 +74,8 @@ class CTernaryGrayCode: public CBinaryGrayCode{
 
     void Initialize(const UINT); ///< Get first code word.
     UINT Next(); ///< Get next code word.
+    void Seek(const UINT64); ///< Jump to code word of given rank.
+    const UINT64 GetRank() const; ///< Get rank of current code word.
 }; //CTernaryGrayCode
 
 #endif //__TernaryGrayCode_h__
\ No newline at end of file
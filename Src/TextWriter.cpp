@@ -0,0 +1,100 @@
+/// \file TextWriter.cpp
+/// \brief Code for the buffered text writer CTextWriter.
+
+// MIT License
+//
+// Copyright (c) 2022 Ian Parberry
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdarg>
+
+#include "TextWriter.h"
+
+const char CTextWriter::m_strDigitPair[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233"
+  "34353637383940414243444546474849505152535455565758596061626364656667"
+  "6869707172737475767778798081828384858687888990919293949596979899";
+
+/// Close the file if it is still open.
+
+CTextWriter::~CTextWriter(){
+  Close();
+} //destructor
+
+/// Create a text file, closing any file that is already open. The file is
+/// opened in text mode so that line ends are translated as usual. The
+/// buffer is allocated the first time and kept after that.
+/// \param lpwstr Null terminated wide file name.
+/// \return True if the file was created.
+
+bool CTextWriter::Open(LPCWSTR lpwstr){
+  Close();
+
+  if(m_vecBuffer.empty()){ //first time
+    m_vecBuffer.resize(m_nBufferSize);
+    m_pBuffer = m_vecBuffer.data();
+  } //if
+
+  m_nCount = 0;
+  m_bFailed = false;
+  _wfopen_s(&m_pOutput, lpwstr, L"wt");
+
+  return m_pOutput != nullptr;
+} //Open
+
+/// Write the buffer to the file and empty it.
+
+void CTextWriter::Flush(){
+  if(m_pOutput && m_nCount > 0 &&
+    fwrite(m_pBuffer, 1, m_nCount, m_pOutput) != m_nCount)
+    m_bFailed = true;
+
+  m_nCount = 0;
+} //Flush
+
+/// Formatted write, with the same format string and arguments as `printf()`.
+/// This is meant for the odd line that needs something other than a string
+/// or an integer, for example a floating point number. The result must be
+/// shorter than 256 characters.
+/// \param format Format string.
+
+void CTextWriter::Printf(const char* format, ...){
+  char s[256]; //formatted string
+
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(s, sizeof(s), format, args);
+  va_end(args);
+
+  if(n > 0)Put(s, (size_t)n < sizeof(s)? (size_t)n: sizeof(s) - 1);
+} //Printf
+
+/// Flush the buffer and close the file.
+/// \return True if everything was written successfully.
+
+bool CTextWriter::Close(){
+  if(m_pOutput == nullptr)return false;
+
+  Flush();
+  if(fclose(m_pOutput) != 0)m_bFailed = true;
+  m_pOutput = nullptr;
+
+  return !m_bFailed;
+} //Close
@@ -293,8 +293,8 @@ HRESULT ExportImage(const eExport t, HWND hwnd, CRenderableComparatorNet* pNet,
   return hr;
 } //ExportImage
 
-/// Pop up a Windows `Open` dialog box for the user to pick a text file
-/// and read the comparator network from there into a comparator network.
+/// Pop up a Windows `Open` dialog box for the user to pick a text or binary
+/// file and read the comparator network from there into a comparator network.
 /// \param hwnd Window handle.
 /// \param pNet [OUT] Pointer to a renderable comparator network.
 /// \param wstrName [IN, OUT] File name without extension.
@@ -303,8 +303,10 @@ HRESULT ExportImage(const eExport t, HWND hwnd, CRenderableComparatorNet* pNet,
 HRESULT Load(HWND hwnd, CComparatorNetwork* pNet,
   std::wstring& wstrName)
 {
-  COMDLG_FILTERSPEC filetypes[] = { //text files only
-    {L"TXT Files", L"*.txt"}
+  COMDLG_FILTERSPEC filetypes[] = { //text and binary files
+    {L"Comparator Networks", L"*.txt;*.snb"},
+    {L"TXT Files", L"*.txt"},
+    {L"SNB Files", L"*.snb"}
   }; //filetypes
 
   HRESULT hr = S_OK; //success or failure
@@ -418,6 +420,7 @@ void CreateHelpMenu(HMENU hParent){
   HMENU hMenu = CreateMenu();
   
   AppendMenuW(hMenu, MF_STRING, IDM_HELP_HELP,    L"Display help...");
+  AppendMenuW(hMenu, MF_STRING, IDM_HELP_SELFTEST, L"Self test...");
   AppendMenuW(hMenu, MF_STRING, IDM_HELP_ABOUT,   L"About...");
   AppendMenuW(hParent, MF_POPUP, (UINT_PTR)hMenu, L"&Help");
 } //CreateHelpMenu
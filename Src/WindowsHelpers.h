@@ -56,6 +56,7 @@
 
 #define IDM_HELP_HELP  15 ///< Menu id for display help.
 #define IDM_HELP_ABOUT 16 ///< Menu id for display About info.
+#define IDM_HELP_SELFTEST 17 ///< Menu id for self test.
 
 #pragma endregion Menu IDs
 